@@ -308,7 +308,7 @@ void Console::parseNmax(const Strings& tokens) const {
             return;
         }
 
-        const int n = atoi(tokens[1].c_str());
+        const long n = atol(tokens[1].c_str());  // Above 2^32 with 64 bit iteration counts (fracfast/types.h)
         if(n < 0)
             std::cout << "Error: Value to small (< 0)" << std::endl;
         else
@@ -320,7 +320,7 @@ void Console::parseNmax(const Strings& tokens) const {
             return;
         }
 
-        const int n = atoi(tokens[1].c_str());
+        const long n = atol(tokens[1].c_str());
         if(n < 0)
             std::cout << "Error: Value to small (< 0)" << std::endl;
         else
@@ -359,6 +359,9 @@ void Console::parseSym() const {
 }
 
 void Console::parseStop() const {
+    program->cancel();
+    juliaProgram->cancel();
+
     SDL_FlushEvent(SDL_MOUSEWHEEL);
     SDL_FlushEvent(SDL_KEYDOWN);
     SDL_FlushEvent(SDL_KEYUP);
@@ -463,7 +466,7 @@ void Console::printHelpSym() const {
 
 void Console::printHelpStop() const {
     std::cout << "  - stop\n"
-              << "        Removes all queued events\n"
+              << "        Stops the current render and removes all queued events\n"
               << '\n';
 }
 
@@ -2,93 +2,155 @@
 // #include "borderTrace.h"
 
 #include "fractal.h"
+#include "kernels.h"
 #include "shapes.h"
 
-#include <queue>
+#include <vector>
 #include <cstdint>
 
 
-// TODO: See which getColor() is faster
-uint32_t Fractal::getColor(BorderTrace& bt, const unsigned int pixel) const {
-    if(bt.pixels[pixel] & COLORED)
-        return bt.pixels[pixel] & COLOR;
-
-    const unsigned int x = pixel % bt.w,
-                       y = pixel / bt.w;
-    
-    double c[2];
-    c[0] = bt.rMin + (x * bt.pixelSize);
-    c[1] = bt.iMax - (y * bt.pixelSize);
-
-    bt.pixels[pixel] = calcPixel(c, bt.data) | COLORED;
-
-    return bt.pixels[pixel] & COLOR;
+// Every thread border traces one tile at a time, so it only needs one state and queue, which keep their memory for the next tile
+static TileState& tileState() {
+    static thread_local TileState state;
+    return state;
 }
 
-uint32_t Fractal::getColor(BorderTrace& bt, const unsigned int x, const unsigned int y) const {
-    const unsigned int _p = y * bt.w + x;
+static Queue& tileQueue() {
+    static thread_local Queue queue;
+    return queue;
+}
 
-    if(bt.pixels[_p] & COLORED)
-        return bt.pixels[_p] & COLOR;
-    
-    double c[2];
-    c[0] = bt.rMin + ((x + bt.xMin) * bt.pixelSize);
-    c[1] = bt.iMax - ((y + bt.yMin) * bt.pixelSize);
+// Index of pixel in the state of its tile; the functions below that get s from their caller do this division once per checkNeighbors
+template<typename Trace>
+static inline unsigned int tileIndex(const Trace& bt, const unsigned int pixel) {
+    return (pixel / bt.w - bt.yMin) * bt.dX + (pixel % bt.w - bt.xMin);
+}
 
-    bt.pixels[_p] = calcPixel(c, bt.data) | COLORED;
 
-    return bt.pixels[_p] & COLOR;
+template<typename Number>
+void Fractal::borderTrace(BasicBorderTrace<Number>& bt) const {
+    edgeInQueue(bt);
+    while(!bt.pixelQueue->empty()) {
+        if(isCancelled(bt.options->cancel))
+            return;  // Filling now would flood the unfinished parts with the colors of the border
+        checkNeighbors(bt, bt.pixelQueue->front());
+        bt.pixelQueue->pop();
+    }
+    fillEmptyPixels(bt);
 }
 
-uint32_t Fractal::getColor(BorderTrace& bt, const unsigned int pixel[2]) const {
-    const unsigned int _p = pixel[1] * bt.w + pixel[0];
 
-    if(bt.pixels[_p] & COLORED)
-        return bt.pixels[_p] & COLOR;
+template<typename Number>
+uint32_t Fractal::getColor(BasicBorderTrace<Number>& bt, const unsigned int pixel, const unsigned int s) const {
+    if(bt.state->is(s, COLORED))
+        return bt.pixels[pixel];
+
+    const unsigned int x = pixel % bt.w,
+                       y = pixel / bt.w;
     
-    double c[2];
-    c[0] = bt.rMin + ((pixel[0] + bt.xMin) * bt.pixelSize);
-    c[1] = bt.iMax - ((pixel[1] + bt.yMin) * bt.pixelSize);
+    Number c[2];
+    c[0] = bt.rMin + (x * bt.pixelSize);
+    c[1] = bt.iMax - (y * bt.pixelSize);
 
-    bt.pixels[_p] = calcPixel(c, bt.data) | COLORED;
+    bt.pixels[pixel] = calcPixel(c, bt.pixelSize, *bt.options);
+    bt.state->set(s, COLORED);
+    if(bt.calculated != nullptr)
+        bt.calculated[pixel] = 1;
 
-    return bt.pixels[_p] & COLOR;
+    return bt.pixels[pixel];
 }
 
-
-void Fractal::addQueue(BorderTrace& bt, const unsigned int pixel) const {
-    if(bt.pixels[pixel] & QUEUED)
+template<typename Number>
+void Fractal::addQueue(BasicBorderTrace<Number>& bt, const unsigned int pixel, const unsigned int s) const {
+    if(bt.state->is(s, QUEUED))
         return;
 
-    bt.pixelQueue.push(pixel);
-    bt.pixels[pixel] |= QUEUED;
+    bt.pixelQueue->push(pixel);
+    bt.state->set(s, QUEUED);
 }
 
 
-void Fractal::edgeInQueue(BorderTrace& bt) const {
-    // This function is only called at start of border trace, so clear queue.
-    bt.pixelQueue = std::queue<unsigned int>();
-    
+template<typename Number>
+void Fractal::edgeInQueue(BasicBorderTrace<Number>& bt) const {
+    // This function is only called at start of border trace, so clear queue and state.
+    bt.pixelQueue = &tileQueue();
+    bt.pixelQueue->reset(2 * (bt.dX + bt.dY));  // The edge; it grows, if the trace needs more
+    bt.state = &tileState();
+    bt.state->reset(bt.dX * bt.dY);
+
+    // Pixels calculated before don't have to be calculated again
+    if(bt.calculated != nullptr)
+        for(unsigned int y = bt.yMin; y < bt.yMax; y++)
+            for(unsigned int x = bt.xMin; x < bt.xMax; x++)
+                if(bt.calculated[y * bt.w + x])
+                    bt.state->set((y - bt.yMin) * bt.dX + (x - bt.xMin), COLORED);
+
+    std::vector<unsigned int> edge;
+    edge.reserve(2 * (bt.dX + bt.dY));
     for(unsigned int y = bt.yMin; y < bt.yMax; y++) {
-        addQueue(bt, y * bt.w + bt.xMin);
-        addQueue(bt, y * bt.w + bt.xMin + (bt.dX - 1));
+        edge.push_back(y * bt.w + bt.xMin);
+        edge.push_back(y * bt.w + bt.xMin + (bt.dX - 1));
         // bt.pixels[y * bt.w + bt.xMin] = 0xFFFFFFFF;  // Color borders white
         // bt.pixels[y * bt.w + bt.xMin + (bt.dX - 1)] = 0xFFFFFFFF;
     }
     for(unsigned int x = bt.xMin + 1; x < bt.xMax - 1; x++) {
-        addQueue(bt, x + (bt.yMin * bt.w));
-        addQueue(bt, x + (bt.yMin * bt.w) + ((bt.dY - 1) * bt.w));
+        edge.push_back(x + (bt.yMin * bt.w));
+        edge.push_back(x + (bt.yMin * bt.w) + ((bt.dY - 1) * bt.w));
         // bt.pixels[x + (bt.yMin * bt.w)] = 0xFFFFFFFF;
         // bt.pixels[x + (bt.yMin * bt.w) + ((bt.dY - 1) * bt.w)] = 0xFFFFFFFF;
     }
+
+    for(auto& pixel : edge)
+        addQueue(bt, pixel, tileIndex(bt, pixel));
+    calcEdge(bt, edge);
 }
 
-void Fractal::checkNeighbors(BorderTrace& bt, const unsigned int pixel) const {
+// Without a vector kernel for the number type, the edge pixels are calculated one at a time by checkNeighbors
+template<typename Number>
+void Fractal::calcEdge(BasicBorderTrace<Number>&, const std::vector<unsigned int>&) const {
+}
+
+// Every pixel on the edge is calculated anyway, so calculate them in batches up front, which can use the vector kernels
+void Fractal::calcEdge(BorderTrace& bt, const std::vector<unsigned int>& edge) const {
+    double cr[BATCHSIZE], ci[BATCHSIZE];
+    uint32_t colors[BATCHSIZE];
+    unsigned int index[BATCHSIZE];
+
+    unsigned int count = 0;
+    for(unsigned int i = 0; i < edge.size(); i++) {
+        const unsigned int pixel = edge[i];
+        if(!bt.state->is(tileIndex(bt, pixel), COLORED)) {
+            cr[count] = bt.rMin + ((pixel % bt.w) * bt.pixelSize);
+            ci[count] = bt.iMax - ((pixel / bt.w) * bt.pixelSize);
+            index[count] = pixel;
+            count++;
+        }
+
+        if(count == BATCHSIZE || (i == edge.size() - 1 && count > 0)) {
+            // The queued pixels that are left get calculated one at a time, or skipped if cancelled
+            if(isCancelled(bt.options->cancel))
+                return;
+            calcPixels(cr, ci, count, bt.pixelSize, *bt.options, colors);
+            for(unsigned int j = 0; j < count; j++) {
+                bt.pixels[index[j]] = colors[j];
+                bt.state->set(tileIndex(bt, index[j]), COLORED);  // All edge pixels are queued already
+                if(bt.calculated != nullptr)
+                    bt.calculated[index[j]] = 1;
+            }
+            count = 0;
+        }
+    }
+}
+
+template<typename Number>
+void Fractal::checkNeighbors(BasicBorderTrace<Number>& bt, const unsigned int pixel) const {
     const unsigned int x = pixel % bt.w,
                        y = pixel / bt.w;
+    const unsigned int s = (y - bt.yMin) * bt.dX + (x - bt.xMin),  // Index in the tile state
+                       dS = bt.dX;
 
     // Calculate current pixel
-    const uint32_t pixelColor = getColor(bt, pixel);
+    const uint32_t pixelColor = getColor(bt, pixel, s);
 
     // Bools for existence of left-, right-, up- and down-neighbor
     // Cache the results, because they are used often
@@ -100,78 +162,184 @@ void Fractal::checkNeighbors(BorderTrace& bt, const unsigned int pixel) const {
     // First calculate 4 the neighbors and check if they are different
     bool rightDifferent = false, leftDifferent = false, downDifferent = false, upDifferent = false;
     if(rightExists)
-        rightDifferent = getColor(bt, pixel + 1) != pixelColor;
+        rightDifferent = getColor(bt, pixel + 1, s + 1) != pixelColor;
     if(leftExists)
-        leftDifferent = getColor(bt, pixel - 1) != pixelColor;
+        leftDifferent = getColor(bt, pixel - 1, s - 1) != pixelColor;
     if(downExists)
-        downDifferent = getColor(bt, pixel + bt.w) != pixelColor;
+        downDifferent = getColor(bt, pixel + bt.w, s + dS) != pixelColor;
     if(upExists)
-        upDifferent = getColor(bt, pixel - bt.w) != pixelColor;
+        upDifferent = getColor(bt, pixel - bt.w, s - dS) != pixelColor;
 
     // Check neighbors of the neighbors which are different
     if(rightDifferent)
-        addQueue(bt, pixel + 1);
+        addQueue(bt, pixel + 1, s + 1);
     if(leftDifferent)
-        addQueue(bt, pixel - 1);
+        addQueue(bt, pixel - 1, s - 1);
     if(downDifferent)
-        addQueue(bt, pixel + bt.w);
+        addQueue(bt, pixel + bt.w, s + dS);
     if(upDifferent)
-        addQueue(bt, pixel - bt.w);
+        addQueue(bt, pixel - bt.w, s - dS);
+
+    // Optimization which introduces more error, for GMP (borderTrace.h)
+    // If any neighbor is different, then also add the diagonals touching this neighbor
+    if(BasicBorderTrace<Number>::GUESSDIAGONALS) {
+        if((rightExists && downExists) && (rightDifferent || downDifferent))
+            addQueue(bt, pixel + bt.w + 1, s + dS + 1);
+        if((rightExists && upExists) && (rightDifferent || upDifferent))
+            addQueue(bt, pixel - bt.w + 1, s - dS + 1);
+        if((leftExists && downExists) && (leftDifferent || downDifferent))
+            addQueue(bt, pixel + bt.w - 1, s + dS - 1);
+        if((leftExists && upExists) && (leftDifferent || upDifferent))
+            addQueue(bt, pixel - bt.w - 1, s - dS - 1);
+        return;
+    }
 
     // Same for diagonals
     bool rdDifferent = false, ruDifferent = false, ldDifferent = false, luDifferent = false;
     if(rightExists && downExists)
-        rdDifferent = getColor(bt, pixel + bt.w + 1) != pixelColor;
+        rdDifferent = getColor(bt, pixel + bt.w + 1, s + dS + 1) != pixelColor;
     if(rightExists && upExists)
-        ruDifferent = getColor(bt, pixel - bt.w + 1) != pixelColor;
+        ruDifferent = getColor(bt, pixel - bt.w + 1, s - dS + 1) != pixelColor;
     if(leftExists && downExists)
-        ldDifferent = getColor(bt, pixel + bt.w - 1) != pixelColor;
+        ldDifferent = getColor(bt, pixel + bt.w - 1, s + dS - 1) != pixelColor;
     if(leftExists && upExists)
-        luDifferent = getColor(bt, pixel - bt.w - 1) != pixelColor;
+        luDifferent = getColor(bt, pixel - bt.w - 1, s - dS - 1) != pixelColor;
 
     if(rdDifferent)
-        addQueue(bt, pixel + bt.w + 1);
+        addQueue(bt, pixel + bt.w + 1, s + dS + 1);
     if(ruDifferent)
-        addQueue(bt, pixel - bt.w + 1);
+        addQueue(bt, pixel - bt.w + 1, s - dS + 1);
     if(ldDifferent)
-        addQueue(bt, pixel + bt.w - 1);
+        addQueue(bt, pixel + bt.w - 1, s + dS - 1);
     if(luDifferent)
-        addQueue(bt, pixel - bt.w - 1);
-
-    // Optimization which intoduces more error
-    // If any neighbor is different, then also add the diagonals touching this neighbor
-    // if((rightExists && downExists) && (rightDifferent || downDifferent))
-    //     addQueue(bt, pixel + bt.w + 1);
-    // if((rightExists && upExists) && (rightDifferent || upDifferent))
-    //     addQueue(bt, pixel - bt.w + 1);
-    // if((leftExists && downExists) && (leftDifferent || downDifferent))
-    //     addQueue(bt, pixel + bt.w - 1);
-    // if((leftExists && upExists) && (leftDifferent || upDifferent))
-    //     addQueue(bt, pixel - bt.w - 1);
+        addQueue(bt, pixel - bt.w - 1, s - dS - 1);
 }
 
 
-void Fractal::fillEmptyPixels(BorderTrace& bt) const {
-    unsigned int pix;
+// The pixels that weren't calculated are inside a border of one value, so they get the value of the pixel left of them
+template<typename Number>
+void Fractal::fillEmptyPixels(BasicBorderTrace<Number>& bt) const {
+    unsigned int pix, s;
     for(unsigned int y = bt.yMin; y < bt.yMax; y++) {
-        for(unsigned int x = bt.xMin + 1; x < bt.xMax; x++) {
+        s = (y - bt.yMin) * bt.dX + 1;
+        for(unsigned int x = bt.xMin + 1; x < bt.xMax; x++, s++) {
             pix = y * bt.w + x;
-            if(!(bt.pixels[pix] & COLORED))
+            if(!bt.state->is(s, COLORED))
                 bt.pixels[pix] = bt.pixels[pix - 1];
+        }
+    }
+}
+
+// Neighbors of a pixel, in the order checkNeighbors checks them
+static const int NEIGHBORX[8] = {1, -1, 0, 0, 1, 1, -1, -1},
+                 NEIGHBORY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+// Pixels taken off the queue per batch; every one of them adds at most itself and its 8 neighbors to the batch
+static const unsigned int FRONTIERPIXELS = BATCHSIZE / 9;
+
+// Border trace that takes a few pixels off the queue at a time, and calculates the ones among them and their neighbors that aren't colored yet
+// with one calcPixels, so the vector kernels are used for the whole trace instead of only the edge
+// Then checks the neighbors like checkNeighbors; the same pixels end up queued, only in a different order
+void Fractal::borderTrace(BorderTrace& bt) const {
+    edgeInQueue(bt);
+
+    double cr[BATCHSIZE], ci[BATCHSIZE];
+    uint32_t colors[BATCHSIZE];
+    unsigned int index[BATCHSIZE];
+    unsigned int frontier[FRONTIERPIXELS];
+
+    while(!bt.pixelQueue->empty()) {
+        if(isCancelled(bt.options->cancel))
+            return;  // Filling now would flood the unfinished parts with the colors of the border
+
+        // Gather the pixels of the batch; they're marked colored right away, so a pixel is only added once
+        unsigned int frontierSize = 0, count = 0;
+        while(!bt.pixelQueue->empty() && frontierSize < FRONTIERPIXELS) {
+            const unsigned int pixel = bt.pixelQueue->front();
+            bt.pixelQueue->pop();
+            frontier[frontierSize++] = pixel;
+
+            const unsigned int x = pixel % bt.w,
+                               y = pixel / bt.w;
+            const unsigned int s = (y - bt.yMin) * bt.dX + (x - bt.xMin);
+
+            if(!bt.state->is(s, COLORED)) {
+                bt.state->set(s, COLORED);
+                cr[count] = bt.rMin + (x * bt.pixelSize);
+                ci[count] = bt.iMax - (y * bt.pixelSize);
+                index[count++] = pixel;
+            }
+
+            for(unsigned int i = 0; i < 8; i++) {
+                const unsigned int nX = x + NEIGHBORX[i],
+                                   nY = y + NEIGHBORY[i];  // Wraps around past 0, so it fails the checks below
+                if(nX < bt.xMin || nX >= bt.xMax || nY < bt.yMin || nY >= bt.yMax)
+                    continue;
+
+                const unsigned int nS = s + NEIGHBORY[i] * (int)bt.dX + NEIGHBORX[i];
+                if(!bt.state->is(nS, COLORED)) {
+                    bt.state->set(nS, COLORED);
+                    cr[count] = bt.rMin + (nX * bt.pixelSize);
+                    ci[count] = bt.iMax - (nY * bt.pixelSize);
+                    index[count++] = nY * bt.w + nX;
+                }
+            }
+        }
+
+        if(count > 0) {
+            calcPixels(cr, ci, count, bt.pixelSize, *bt.options, colors);
+            for(unsigned int j = 0; j < count; j++) {
+                bt.pixels[index[j]] = colors[j];
+                if(bt.calculated != nullptr)
+                    bt.calculated[index[j]] = 1;
+            }
+        }
 
-            // Maybe clear alpha bits?
-            // bt.pixels[pix] &= 0xFFFFFF00;
+        // Queue the neighbors that are different
+        for(unsigned int f = 0; f < frontierSize; f++) {
+            const unsigned int pixel = frontier[f],
+                               x = pixel % bt.w,
+                               y = pixel / bt.w;
+            const unsigned int s = (y - bt.yMin) * bt.dX + (x - bt.xMin);
+            const uint32_t pixelColor = bt.pixels[pixel];
+
+            for(unsigned int i = 0; i < 8; i++) {
+                const unsigned int nX = x + NEIGHBORX[i],
+                                   nY = y + NEIGHBORY[i];
+                if(nX < bt.xMin || nX >= bt.xMax || nY < bt.yMin || nY >= bt.yMax)
+                    continue;
+
+                const unsigned int nPixel = nY * bt.w + nX;
+                if(bt.pixels[nPixel] != pixelColor)
+                    addQueue(bt, nPixel, s + NEIGHBORY[i] * (int)bt.dX + NEIGHBORX[i]);
+            }
         }
     }
+
+    fillEmptyPixels(bt);
 }
 
+// The fractals call borderTrace() from other translation units; doubles use the batched one above
+template void Fractal::borderTrace(BasicBorderTrace<DoubleDouble>& bt) const;
+template void Fractal::borderTrace(HighPrecBorderTrace& bt) const;
+
+
 
+// Interior points are the ones periodicity checking saves the most on, as they would take nMax iterations of several mpf multiplies
+// The check is a subtraction and a comparison per part, and the imaginary part is only checked when the real part is close
+static inline bool withinEpsilon(mpf_t diff, const mpf_t a, const mpf_t b, const mpf_t epsilon) {
+    mpf_sub(diff, a, b);
+    mpf_abs(diff, diff);
+    return mpf_cmp(diff, epsilon) < 0;
+}
 
 uint32_t Fractal::calcGMPPixel(HighPrecBorderTrace& bt) const {
     mpf_set_ui(bt.zr, 0);
     mpf_set_ui(bt.zi, 0);
     mpf_set_ui(bt.zSquaredr, 0);
     mpf_set_ui(bt.zSquaredi, 0);
+    mpf_set_ui(bt.savedr, 0);
+    mpf_set_ui(bt.savedi, 0);
 
     iter_t n = 0;
     for(; n < nMax; n++) {
@@ -189,14 +357,24 @@ uint32_t Fractal::calcGMPPixel(HighPrecBorderTrace& bt) const {
 
         mpf_mul(bt.zSquaredr, bt.zr, bt.zr);
         mpf_mul(bt.zSquaredi, bt.zi, bt.zi);
+
+        // dist is free until the next iteration
+        if(withinEpsilon(bt.dist, bt.zr, bt.savedr, bt.epsilon) && withinEpsilon(bt.dist, bt.zi, bt.savedi, bt.epsilon)) {
+            periodicCount.add(1);
+            return 0x0;
+        }
+        if((n & (n + 1)) == 0) {
+            mpf_set(bt.savedr, bt.zr);
+            mpf_set(bt.savedi, bt.zi);
+        }
     }
 
-    return calcColor(n);
+    return packIterations(n, nMax);
 }
 
-uint32_t Fractal::getColor(HighPrecBorderTrace& bt, const unsigned int pixel) const {
-    if(bt.pixels[pixel] & COLORED)
-        return bt.pixels[pixel] & COLOR;
+uint32_t Fractal::getColor(HighPrecBorderTrace& bt, const unsigned int pixel, const unsigned int s) const {
+    if(bt.state->is(s, COLORED))
+        return bt.pixels[pixel];
 
     const unsigned int x = pixel % bt.w,
                        y = pixel / bt.w;
@@ -209,93 +387,12 @@ uint32_t Fractal::getColor(HighPrecBorderTrace& bt, const unsigned int pixel) co
     mpf_mul_ui(bt.ci, bt.pixelSize, y);
     mpf_sub(bt.ci, bt.iMax, bt.ci);
 
-    bt.pixels[pixel] = calcGMPPixel(bt) | COLORED;
+    bt.pixels[pixel] = calcGMPPixel(bt);
+    bt.state->set(s, COLORED);
+    if(bt.calculated != nullptr)
+        bt.calculated[pixel] = 1;
 
-    return bt.pixels[pixel] & COLOR;
+    return bt.pixels[pixel];
 }
 
 
-// TODO: Use templates to remove duplicate code
-void Fractal::addQueue(HighPrecBorderTrace& bt, const unsigned int pixel) const {
-    if(bt.pixels[pixel] & QUEUED)
-        return;
-
-    bt.pixelQueue.push(pixel);
-    bt.pixels[pixel] |= QUEUED;
-}
-
-
-void Fractal::edgeInQueue(HighPrecBorderTrace& bt) const {
-    // This function is only called at start of border trace, so clear queue.
-    bt.pixelQueue = std::queue<unsigned int>();
-    
-    for(unsigned int y = bt.yMin; y < bt.yMax; y++) {
-        addQueue(bt, y * bt.w + bt.xMin);
-        addQueue(bt, y * bt.w + bt.xMin + (bt.dX - 1));
-    }
-    for(unsigned int x = bt.xMin + 1; x < bt.xMax - 1; x++) {
-        addQueue(bt, x + (bt.yMin * bt.w));
-        addQueue(bt, x + (bt.yMin * bt.w) + ((bt.dY - 1) * bt.w));
-    }
-}
-
-
-void Fractal::checkNeighbors(HighPrecBorderTrace& bt, const unsigned int pixel) const {
-    const unsigned int x = pixel % bt.w,
-                       y = pixel / bt.w;
-
-    // Calculate current pixel
-    const uint32_t pixelColor = getColor(bt, pixel);
-
-    // Bools for existence of left-, right-, up- and down-neighbor
-    // Cache the results, because they are used often
-    const bool rightExists = x < bt.xMax - 1,
-               leftExists = x > bt.xMin,
-               downExists = y < bt.yMax - 1,
-               upExists = y > bt.yMin;
-
-    // First calculate 4 the neighbors and check if they are different
-    bool rightDifferent = false, leftDifferent = false, downDifferent = false, upDifferent = false;
-    if(rightExists)
-        rightDifferent = getColor(bt, pixel + 1) != pixelColor;
-    if(leftExists)
-        leftDifferent = getColor(bt, pixel - 1) != pixelColor;
-    if(downExists)
-        downDifferent = getColor(bt, pixel + bt.w) != pixelColor;
-    if(upExists)
-        upDifferent = getColor(bt, pixel - bt.w) != pixelColor;
-
-    // Check neighbors of the neighbors which are different
-    if(rightDifferent)
-        addQueue(bt, pixel + 1);
-    if(leftDifferent)
-        addQueue(bt, pixel - 1);
-    if(downDifferent)
-        addQueue(bt, pixel + bt.w);
-    if(upDifferent)
-        addQueue(bt, pixel - bt.w);
-
-    // If any neighbor is different, then also add the diagonals touching this neighbor
-    if((rightExists && downExists) && (rightDifferent || downDifferent))
-        addQueue(bt, pixel + bt.w + 1);
-    if((rightExists && upExists) && (rightDifferent || upDifferent))
-        addQueue(bt, pixel - bt.w + 1);
-    if((leftExists && downExists) && (leftDifferent || downDifferent))
-        addQueue(bt, pixel + bt.w - 1);
-    if((leftExists && upExists) && (leftDifferent || upDifferent))
-        addQueue(bt, pixel - bt.w - 1);
-}
-
-void Fractal::fillEmptyPixels(HighPrecBorderTrace& bt) const {
-    unsigned int pix;
-    for(unsigned int y = bt.yMin; y < bt.yMax; y++) {
-        for(unsigned int x = bt.xMin + 1; x < bt.xMax; x++) {
-            pix = y * bt.w + x;
-            if(!(bt.pixels[pix] & COLORED))
-                bt.pixels[pix] = bt.pixels[pix - 1];
-
-            // Maybe clear alpha bits?
-            // bt.pixels[pix] &= 0xFFFFFF00;
-        }
-    }
-}
@@ -3,41 +3,86 @@
 #define BORDER_TRACE
 
 
-#include <queue>
+#include <vector>
 #include <cstdint>
 
+#include "queue.h"
+#include "renderOptions.h"
 #include "shapes.h"
+#include "types.h"
 
 
 #define COLORED 0b01
 #define QUEUED  0b10
 
-#define COLOR 0xFFFFFF00
 
+// Border trace flags of the pixels of a tile, 2 bits per pixel, kept out of the pixels so those only get the values of the fractal, once
+// Indexed from the top left of the tile, so it's small enough to stay in cache; every thread reuses its own for the next tiles and frames
+class TileState {
+    public:
+        // Clears the flags of count pixels, without giving memory back
+        void reset(const unsigned int count) {
+            words.assign((count + PERWORD - 1) / PERWORD, 0);
+        }
 
-struct BorderTrace {
-    std::queue<unsigned int> pixelQueue;
+        bool is(const unsigned int i, const unsigned int flag) const {
+            return (words[i / PERWORD] >> ((i % PERWORD) * 2)) & flag;
+        }
+
+        void set(const unsigned int i, const unsigned int flag) {
+            words[i / PERWORD] |= (uint64_t)flag << ((i % PERWORD) * 2);
+        }
+
+
+    private:
+        static const unsigned int PERWORD = 32;  // Pixels per word
+
+        std::vector<uint64_t> words;
+};
+
+
+// The tile, its pixels and the state of a border trace, the same for every number type
+struct TileTrace {
+    Queue* pixelQueue;  // Set up by edgeInQueue, like state
     uint32_t* pixels;
-    double rMin, iMax, pixelSize;
+    TileState* state;  // Set up by edgeInQueue
     unsigned int w, h;
     unsigned int xMin, xMax, yMin, yMax, dX, dY;
-    void* data;
+    const RenderOptions* options;  // Its cancel token is checked before every pixel taken from the queue
+    // Optional, a byte per pixel of the screen: pixels set in it have their value already and aren't calculated again,
+    // the pixels the border trace calculates are set in it. Progressive rendering carries the samples of a pass over to the next one with it
+    uint8_t* calculated = nullptr;
+
+    // checkNeighbors only queues the diagonals next to a different neighbor, instead of calculating all 8 neighbors
+    // Misses more of the thin parts of the border; only for GMP, where a pixel costs far more than a wrong one is worth
+    static const bool GUESSDIAGONALS = false;
 };
 
-struct HighPrecBorderTrace {
-    std::queue<unsigned int> pixelQueue;
-    uint32_t* pixels;
+// Number is the type the pixel coordinates are calculated in (double, DoubleDouble or mpf_t); the border trace in borderTrace.cpp works with all of them
+template<typename Number>
+struct BasicBorderTrace : TileTrace {
+    Number rMin, iMax, pixelSize;
+};
+
+typedef BasicBorderTrace<double> BorderTrace;
+
+// GMP numbers have no operators, so the pixels are calculated by Fractal::calcGMPPixel, with the variables below
+template<>
+struct BasicBorderTrace<mpf_t> : TileTrace {
     mpf_t rMin, iMax, pixelSize;
-    unsigned int w, h;
-    unsigned int xMin, xMax, yMin, yMax, dX, dY;
-    void* data;
+
+    static const bool GUESSDIAGONALS = true;
 
     // "Global", so they don't have to be initialized every function call
     mpf_t zr, zi,
           cr, ci,
           zSquaredr, zSquaredi,
-          dist;
+          dist,
+          savedr, savedi,  // For periodicity checking
+          epsilon;
 };
 
+typedef BasicBorderTrace<mpf_t> HighPrecBorderTrace;
+
 
 #endif  // BORDER_TRACE
@@ -0,0 +1,216 @@
+// Generated by genBulbs.cpp (make bulbs), don't edit
+// Discs inside the hyperbolic components of period 3 to 24 with a radius of at least 0.001, of the upper half of the set
+// The cardioid and the period 2 bulb are not in it, as inCardioid and in2Bulb test those exactly
+
+// center r, center i, radius, period
+static const Bulb BULBTABLE[] = {
+    {-0.1225611668766536, 0.74486176661974424, 0.090613216120846371, 3},
+    {-1.3107026413368328, 0, 0.056442704436149647, 4},
+    {0.28227139076691427, 0.53006061757852585, 0.041773761565939913, 4},
+    {-0.50434017544624399, 0.56276576145298196, 0.037814952609362899, 5},
+    {-1.138000666650965, 0.24033240126209823, 0.025236281961425296, 6},
+    {0.37951358801592372, 0.33493230559749754, 0.022356720637353035, 5},
+    {-0.11341865594943658, 0.86056947250157301, 0.021523138233850519, 6},
+    {-0.62243629504129361, 0.42487843647562917, 0.019947364957026665, 7},
+    {0.12119278610590641, 0.61061169221075473, 0.016063761517041322, 7},
+    {-0.35910239011244938, 0.6173534533988273, 0.014600954876377989, 8},
+    {-0.99944238720656753, 0.26538753246840718, 0.014333427292542228, 8},
+    {0.3890068405697712, 0.21585065087081909, 0.013258428443902083, 6},
+    {-1.3815474844320617, 0, 0.012288837290757191, 8},
+    {-0.67233317485911859, 0.33771490173774016, 0.012205010068347047, 9},
+    {0.32481970146545963, 0.56381562214033365, 0.01031468118457916, 8},
+    {-0.21070552677901644, 0.80463563817009853, 0.0099970958994923514, 9},
+    {-1.2103996374179795, 0.15287477207775452, 0.0099112167475336466, 10},
+    {-0.53308968145072133, 0.60230975824820088, 0.0096875426613792451, 10},
+    {-0.91927854524410202, 0.24704812127399128, 0.0092231162828620376, 10},
+    {-0.031552974812923656, 0.79078317540640031, 0.0090793881802865312, 9},
+    {0.37600868184676767, 0.14474937132163293, 0.0084714326318867123, 7},
+    {0.050271834823355087, 0.63046855229393639, 0.0082354865795786734, 10},
+    {-0.69783819512242551, 0.27930413410136573, 0.0081992485466831581, 11},
+    {0.32890294729648223, 0.41091259089297039, 0.0080495019025360968, 9},
+    {-0.29390290553037601, 0.63286196180227106, 0.0076366826440655063, 11},
+    {-0.56295982995324356, 0.47146523204111918, 0.0068857161686598735, 12},
+    {-0.87126641635897673, 0.22231791483467023, 0.0064273293250012766, 12},
+    {0.17231188609579048, 0.57075995905593979, 0.0063738403442832369, 11},
+    {-0.71257759267127319, 0.23779256820951977, 0.0058719942867277658, 13},
+    {-1.1519386234587838, 0.26912981234847344, 0.0058003440376530897, 12},
+    {-1.3441962594164381, 0.054945773904599461, 0.0057703684084843493, 12},
+    {0.35903106283661446, 0.10093487686429756, 0.0057270083816117756, 8},
+    {-0.22532347272445641, 0.75107275495205705, 0.0056981363307217238, 12},
+    {-0.40710408308509827, 0.58485284286810291, 0.0056901429616129512, 13},
+    {0.40851818511608123, 0.34003806413743254, 0.0056683013369589813, 10},
+    {-0.64408343421857228, 0.44043117946649557, 0.0053667530456067139, 14},
+    {-1.0567405087275474, 0.24882738901994245, 0.0051187485403962635, 14},
+    {-0.024795632537459634, 0.7406849675737488, 0.0051142722988966327, 12},
+    {-1.2299715853972337, 0.11067141995198433, 0.0051113707072452334, 14},
+    {0.010944463981061444, 0.63822889336273592, 0.0049579706540751932, 13},
+    {0.27393476387599341, 0.57968670493720353, 0.0048365748246253061, 12},
+    {-0.84076073651497762, 0.19927228238087552, 0.0047345505621251352, 14},
+    {-0.11026826739331091, 0.88746181488233566, 0.0047264451508252881, 12},
+    {-1.7548776662466927, 0, 0.004722618188806948, 3},
+    {-0.25705385916688206, 0.63933926877650438, 0.0046642052855703619, 14},
+    {0.37603029289713169, 0.26646760527623653, 0.0045528226195347644, 11},
+    {-0.72185158221480739, 0.20688394681575548, 0.0044055188380463378, 15},
+    {0.13104320675017342, 0.62980226885759794, 0.0043694705544048557, 14},
+    {-1.7728929033816236, 0, 0.0042588136147394366, 6},
+    {0.3264900316687111, 0.51399186571945432, 0.004152105434978565, 12},
+    {-0.36599018689119034, 0.63600943594611103, 0.00405891478898568, 16},
+    {0.34320449315556173, 0.072842377887595303, 0.0040462158304618908, 9},
+    {-0.4863047331339449, 0.60212673960184415, 0.0040252396125380462, 15},
+    {0.30636248360996526, 0.43886908514849143, 0.0040248770131601384, 13},
+    {-0.54729632871509104, 0.55783950315534692, 0.0040056834762117631, 15},
+    {-0.64207383456515366, 0.37033925006912932, 0.0039556153174058212, 16},
+    {-1.1795879099356186, 0.1796534607084562, 0.0039467267226848428, 16},
+    {-0.17423249938456864, 0.82894592338465756, 0.0037859152015390176, 15},
+    {-0.2201298107640364, 0.71865052239747707, 0.0036565610371240621, 15},
+    {-0.82032556806724088, 0.17939058555048945, 0.0036328226093147128, 16},
+    {-0.061317457072725831, 0.81887598879554913, 0.0035934976307568671, 15},
+    {-0.53886239632556698, 0.48962072628514924, 0.0034281544241096186, 17},
+    {-0.99732252443126002, 0.28367933368028669, 0.0034271317882813902, 16},
+    {-0.72806158795578557, 0.18301809124718701, 0.0034241376885395004, 17},
+    {0.40642478183355546, 0.21305937312132972, 0.0034155348766631601, 12},
+    {-1.3124302636776917, 0.062537499864710924, 0.0033860695073289816, 16},
+    {0.19436591322361479, 0.5519865737330244, 0.0033763687922358189, 15},
+    {-0.68736837856004862, 0.34474955805648916, 0.0033607092967153796, 18},
+    {-0.032140158801746525, 0.7118940342211193, 0.0033030125696698128, 15},
+    {-0.013993010399002652, 0.64204792694194845, 0.0032960938989199818, 16},
+    {0.33952834150720923, 0.38038418798814894, 0.0032620765904322977, 14},
+    {-0.23339229625972488, 0.6426515555405109, 0.0031328486182617766, 17},
+    {-0.95598935695636689, 0.24932419440761158, 0.003115245125307291, 18},
+    {-1.2379324800858595, 0.086522181611518187, 0.0030976775759619835, 18},
+    {-0.42799979986113362, 0.570209402304373, 0.0029865435482599413, 18},
+    {0.32968990510380702, 0.054137451948017931, 0.0029615813459648596, 10},
+    {-0.8060229060410451, 0.16255522362161196, 0.0028758833508225759, 18},
+    {0.076784476105561467, 0.61522675039495445, 0.0028562531565805957, 17},
+    {0.3755250702981861, 0.17734056705240517, 0.0028098799513175607, 13},
+    {-0.57857675435526201, 0.44916137230365982, 0.0027797547654948565, 19},
+    {-1.1674708183807072, 0.2427558076580951, 0.002749706200589376, 18},
+    {-0.73242222281805291, 0.16405253349474153, 0.0027361786458041993, 19},
+    {0.25059311941617346, 0.5668672290096044, 0.0027225231043722532, 16},
+    {0.38811060831515864, 0.36101554589349416, 0.0026866014875206313, 15},
+    {-1.3969453597045594, 0, 0.0026406984268240114, 16},
+    {-0.31886053919953927, 0.61954067300444293, 0.0026299091431511647, 19},
+    {-0.68011137377994779, 0.30261598827230435, 0.002555609415828412, 20},
+    {-1.0780709107343767, 0.24022104945236508, 0.0025440481909899701, 20},
+    {-0.21121305957616199, 0.69896739207951686, 0.0025391964351641869, 18},
+    {-1.1228363411933795, 0.26438298415351896, 0.0025209083851512482, 18},
+    {-1.2206943406054065, 0.16036232637294504, 0.0025154590833253287, 20},
+    {0.14934022037860659, 0.58006965137037259, 0.0024488387323966273, 18},
+    {0.29379857351741034, 0.45343138686255069, 0.0023895368450063507, 17},
+    {-0.031205570836886697, 0.64420752398286962, 0.0023435039748745494, 19},
+    {0.053415465447978538, 0.64140059419846873, 0.0023428884704289029, 20},
+    {-0.79564511605385879, 0.14830903098758672, 0.0023334786311626529, 20},
+    {-0.2216756762904592, 0.81112634514248716, 0.0023300855691220038, 18},
+    {-0.041395364843656392, 0.69454031924413817, 0.0023164107349887119, 18},
+    {0.31187639381529214, 0.49613239793400593, 0.0023130591346865112, 16},
+    {0.33552480141166735, 0.5712580167817094, 0.0022927153234163881, 16},
+    {-0.7085229333645755, 0.2828097931069834, 0.0022777495528290923, 22},
+    {0.33872540532170853, 0.41603697547888724, 0.0022749739670988563, 18},
+    {-0.61920404638911875, 0.44842503519527577, 0.0022731696042429129, 21},
+    {-0.91401906710632874, 0.25779203508242771, 0.0022538653335216633, 20},
+    {-0.21691879073798753, 0.64457185188250221, 0.0022444841536685724, 20},
+    {-0.13299567399914222, 0.87550996789859814, 0.0022373992496169458, 18},
+    {0.37034844356535396, 0.28561351169338034, 0.0022360535991634962, 16},
+    {-0.73560102423423357, 0.14862754459634867, 0.0022357773360016349, 21},
+    {-1.3597665334429498, 0.034438543107066386, 0.0022333618942543786, 20},
+    {0.31847226665803058, 0.041257369922169239, 0.00223135319008754, 11},
+    {-1.2931604519389042, 0.059289972547317771, 0.0022173846257963789, 20},
+    {0.39631523357622478, 0.31610683378473098, 0.0022107579149085997, 15},
+    {0.38647375332106826, 0.14035280421717172, 0.0022039618996506855, 14},
+    {-0.47067119718338524, 0.5865936409060829, 0.002203622021492956, 20},
+    {-0.53743637019183199, 0.53819335356522335, 0.0021978753277589972, 20},
+    {-0.38616041628013764, 0.59140448639552934, 0.0021906773618847256, 21},
+    {-0.29611066565049038, 0.64325881518274319, 0.002189191237777618, 22},
+    {-0.091250927657567218, 0.87062529041243497, 0.0021863589582754909, 18},
+    {-0.54031402405854834, 0.61219754233987589, 0.0021763094743026418, 20},
+    {-1.0358486131450555, 0.24958609231919832, 0.0021039923398302423, 22},
+    {-0.02075665644714856, 0.79495571927550301, 0.0020988962004732932, 18},
+    {-0.64329866653758538, 0.41525759993589928, 0.0020977401659419406, 21},
+    {-1.1650856892445709, 0.1905873838060102, 0.002097076887193705, 22},
+    {-0.89522347989736573, 0.22933633113797003, 0.0020925580701783857, 22},
+    {-0.15652016683375508, 1.0322471089228318, 0.0020888464028298252, 4},
+    {0.20665820318230441, 0.54108527698458242, 0.0020778580254906141, 19},
+    {-1.2419363540926063, 0.070972132726558307, 0.0020706885806349444, 22},
+    {-0.52580840970542608, 0.49933150866979564, 0.0020357814582090974, 22},
+    {-0.56979731579545778, 0.47838554777325598, 0.0020333434601594435, 24},
+    {-0.21692320764353976, 0.77322590592009344, 0.0020195507385187051, 21},
+    {-0.16286770706725501, 1.0373132408104249, 0.0019369863003936393, 8},
+    {-0.15755428206484762, 0.83465517973762149, 0.0019317555858919604, 21},
+    {-0.78788714855365238, 0.13618595842489234, 0.0019315191202699572, 22},
+    {-0.63082839451717865, 0.38305114721451539, 0.001917484371173649, 23},
+    {0.37543640596468708, 0.24821597045778648, 0.0018732525477720553, 17},
+    {-0.20249280288089419, 0.68642498351119308, 0.0018646384798867532, 21},
+    {-0.076016240587858525, 0.82713180511518958, 0.0018626189953583063, 21},
+    {-0.73798946248215103, 0.13584107226725894, 0.0018606894315846133, 23},
+    {0.1775642135984849, 0.57798559722032317, 0.0018523192236488636, 22},
+    {0.3624835876927765, 0.1223218938884479, 0.0018504926338255396, 15},
+    {-0.029997784388873426, 0.76154944192598228, 0.0018407255610462822, 21},
+    {-0.4397295422769984, 0.56188896427475565, 0.0018273399526029398, 23},
+    {0.29434759332301969, 0.57488941832353946, 0.0018037140517629018, 20},
+    {0.11040648584827482, 0.62622553038169759, 0.0017904580112032031, 21},
+    {-0.70115573454080937, 0.25508515660130843, 0.0017831141031898446, 24},
+    {-1.2180755609271816, 0.12590928485605477, 0.0017827900963217379, 24},
+    {-0.043798532838682562, 0.64554783080987965, 0.001748991926935428, 22},
+    {0.34426423087494212, 0.36639036342956949, 0.0017450365079417557, 19},
+    {0.13988134883693332, 0.61115141127401107, 0.0017318100331258713, 21},
+    {0.24137104983896354, 0.55420746764046436, 0.0017281284777443634, 20},
+    {0.3092292212365742, 0.032123926984394764, 0.0017222001320417982, 12},
+    {-0.049938042710702797, 0.68342575747215106, 0.0017173306525101162, 21},
+    {-0.20479112729285995, 0.64578462204188392, 0.00168490516306305, 23},
+    {-0.37647222500415917, 0.61956306227659241, 0.001669065894623595, 24},
+    {-1.7577830600830981, 0.013796143369485181, 0.0016617590754239931, 9},
+    {0.32671320678615184, 0.53282344873300591, 0.0016604020243447296, 20},
+    {-1.0133103832243775, 0.27557729379908125, 0.0016437505145694502, 24},
+    {0.39891918285117772, 0.22908831879837627, 0.0016390670436790677, 18},
+    {-0.78194098982003546, 0.12578945687716031, 0.0016253410386209918, 24},
+    {0.02692499041483928, 0.6304756414079794, 0.0016044322904779193, 23},
+    {-1.1639406102508072, 0.22778275619905511, 0.0015950582223686097, 24},
+    {-0.8659904697710008, 0.22883902856269675, 0.0015895498952985592, 24},
+    {0.28580813849479236, 0.46237710269452226, 0.0015743567182888813, 21},
+    {-0.34793225333528732, 0.63024435047427707, 0.0015717990303939795, 24},
+    {-1.2812754268512885, 0.053959121655943104, 0.0015615130875056087, 24},
+    {-0.18561869694330199, 0.81827972420383344, 0.0015169854855484025, 24},
+    {0.36549408632395558, 0.096728447819911675, 0.0014990955741536656, 16},
+    {0.37342001485645576, 0.36065182893274278, 0.001495666708443042, 20},
+    {0.30007043958432039, 0.48953816670166178, 0.001490378641862118, 20},
+    {-1.1138472738947587, 0.2534833192368412, 0.0014408940377395852, 24},
+    {-0.19483136668652223, 0.67803083987564527, 0.0014270964845589473, 24},
+    {0.087673977566134889, 0.60929726586714728, 0.0014254720728115386, 24},
+    {-0.052474967972157345, 0.8070952507763085, 0.0014247762908288022, 24},
+    {-0.98492114739388736, 0.27235767198599586, 0.0014121329758658484, 24},
+    {0.31223861764928307, 0.42524334352865795, 0.0014049792487862004, 22},
+    {0.21449797205791263, 0.53396512521069306, 0.0014028251884649109, 23},
+    {-0.23267689699687852, 0.75061487948980121, 0.0013720984922957129, 24},
+    {0.37527937679370776, 0.18952736289167302, 0.0013622484949392098, 19},
+    {0.30160283593729764, 0.025479554236648671, 0.0013565931776588658, 13},
+    {-0.057304190448388699, 0.6759254495145981, 0.0013253856636626742, 24},
+    {-1.3477554964870253, 0.061315497264923836, 0.0013206899309625366, 24},
+    {0.38237345135480444, 0.26702150119937823, 0.0013187498836322183, 22},
+    {0.36723578639270171, 0.29571179249420521, 0.0013145108053281354, 21},
+    {0.39481699714994067, 0.20203030657896975, 0.001305544424478612, 18},
+    {-0.13707725436003598, 0.86357684273548763, 0.0013039364171840559, 24},
+    {0.34759688017414564, 0.087305577866997733, 0.0012810259152013744, 17},
+    {0.41571134940313897, 0.34069017863620549, 0.0012773857441470721, 20},
+    {-1.476014642728432, 0, 0.0012770495557344235, 6},
+    {-0.089997200172463362, 0.85838959496417377, 0.0012682698882441048, 24},
+    {-1.1548976065839101, 0.27578912998196514, 0.0012647534492343949, 24},
+    {-1.3889624928552999, 0.011947658568979358, 0.0012546557657098607, 24},
+    {0.33215105275302687, 0.39052315750871985, 0.0012402438133266448, 23},
+    {0.38494265224367619, 0.31147139909054833, 0.0012220297504736311, 20},
+    {-0.018302169075809747, 0.73957459012722759, 0.0012182398970989636, 24},
+    {0.23779321271815082, 0.54461657273899788, 0.001191117996710125, 24},
+    {0.35925922475800737, 0.64251373713854232, 0.0011703938057709658, 5},
+    {0.37232288524536561, 0.16653220227452162, 0.001169208755202389, 20},
+    {-1.4809254501621609, 0, 0.001155973073076969, 12},
+    {0.272488523000329, 0.58572071385570268, 0.0011414078567706584, 24},
+    {0.35718213907634472, 0.64671755874707915, 0.0011305270143671822, 10},
+    {0.32383813753719143, 0.57563541832215614, 0.0010885736348414355, 24},
+    {0.29527785479128815, 0.020536853286571927, 0.0010874047507367477, 14},
+    {0.34695261638023189, 0.35835637204837401, 0.0010801949770236586, 24},
+    {0.38421498973942064, 0.15159896804920189, 0.0010697562475425531, 21},
+    {0.34732797970288509, 0.069253743827806705, 0.0010631061373218037, 18},
+    {0.29145817672087143, 0.48711391453977043, 0.0010454518792195934, 24},
+    {0.33539761557330616, 0.55902222166354598, 0.0010444078713839529, 24},
+    {-0.10953465772788665, 0.89333826985774856, 0.0010157069708523687, 24},
+    {0.37523530939833771, 0.23974388553551398, 0.0010092800898385496, 23},
+};
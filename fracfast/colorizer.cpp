@@ -0,0 +1,125 @@
+#include "colorizer.h"
+#include "threadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+// Below this many pixels the colorizer doesn't wake the thread pool
+static const unsigned int MINPOOLPIXELS = 1 << 16;
+
+// Period of the cyclic palette in iterations
+static const iter_t CYCLE = 512;
+
+
+// Calls colorRun(first, last) for parts of [0, count), on all threads of the pool for large frames
+// While the pool renders (for another window), all of it is colored on the calling thread instead of waiting for the render
+template<typename ColorRun>
+static void colorParallel(const unsigned int count, const ColorRun& colorRun) {
+    const unsigned int workers = (count < MINPOOLPIXELS ? 1 : threadPool().size());
+    if(workers == 1) {
+        colorRun(0, count);
+        return;
+    }
+
+    const unsigned int part = (count + workers - 1) / workers;
+    const bool ran = threadPool().tryRun(workers, [&](const unsigned int worker) {
+        const unsigned int first = std::min(worker * part, count);
+        colorRun(first, std::min(first + part, count));
+    });
+    if(!ran)
+        colorRun(0, count);
+}
+
+
+// The loops have no branches, so they are vectorized (omp simd) with the instruction set the library is compiled for
+// Floats are precise enough for 8 bit channels and fit twice as many in a vector
+
+// 9(1-t)t^3, 15(1-t)^2t^2 and 8.5(1-t)^3t for red, green and blue; black at t = 0 and t = 1
+static void colorPolynomial(const uint32_t* values, uint32_t* pixels, const unsigned int first, const unsigned int last, const iter_t nMax) {
+    const float scale = 1.0f / nMax;
+
+    #pragma omp simd
+    for(unsigned int i = first; i < last; i++) {
+        const uint32_t stored = values[i];  // n + 1 (colorizer.h)
+        const float t = (stored - 1) * scale,
+                    s = 1.0f - t;
+
+        const uint32_t r = 9.0f * s * t * t * t * 255.0f,
+                       g = 15.0f * s * s * t * t * 255.0f,
+                       b = 8.5f * s * s * s * t * 255.0f;
+
+        const uint32_t inSet = (stored == 0 ? 0x0 : 0xFFFFFFFF);  // A mask instead of a branch
+        pixels[i] = ((r << 24) | (g << 16) | (b << 8)) & inSet;
+    }
+}
+
+// t goes up and back down every cycle, so there is no edge where it starts over, and stays away from the black ends of the polynomial
+static void colorCyclic(const uint32_t* values, uint32_t* pixels, const unsigned int first, const unsigned int last) {
+    const float half = CYCLE / 2;
+
+    #pragma omp simd
+    for(unsigned int i = first; i < last; i++) {
+        const uint32_t stored = values[i],
+                       n = stored - 1;
+        const float phase = (n % CYCLE) / half,
+                    t = 0.15f + 0.7f * (1.0f - std::fabs(phase - 1.0f)),
+                    s = 1.0f - t;
+
+        const uint32_t r = 9.0f * s * t * t * t * 255.0f,
+                       g = 15.0f * s * s * t * t * 255.0f,
+                       b = 8.5f * s * s * s * t * 255.0f;
+
+        const uint32_t inSet = (stored == 0 ? 0x0 : 0xFFFFFFFF);
+        pixels[i] = ((r << 24) | (g << 16) | (b << 8)) & inSet;
+    }
+}
+
+static void colorBlackWhite(const uint32_t* values, uint32_t* pixels, const unsigned int first, const unsigned int last) {
+    #pragma omp simd
+    for(unsigned int i = first; i < last; i++)
+        pixels[i] = (values[i] == 0 ? 0x0 : 0xFFFFFF00);
+}
+
+// Ugly coloring from thesis
+// Use nMax = 500 for graphics in thesis
+// uint32_t calcColor(const iter_t n) const {
+//     double t = n / (double)nMax;
+//     return (uint32_t)(t * 256 * 256 * 256) << 8;
+
+//     // This method was also used for the graphics in the thesis, it changes red->blue, blue->green and green->red, because it prettier
+//     uint32_t rgba = (uint32_t)(t * 256 * 256 * 256) << 8;
+//     uint8_t r = (rgba & 0xFF000000) >> 24;
+//     uint8_t g = (rgba & 0x00FF0000) >> 16;
+//     uint8_t b = (rgba & 0x0000FF00) >> 8;
+    
+//     return (r << 8) | (g << 24) | (b << 16);
+// }
+
+static void colorDistanceRun(const uint32_t* values, uint32_t* pixels, const unsigned int first, const unsigned int last, const float lineWidth) {
+    #pragma omp simd
+    for(unsigned int i = first; i < last; i++) {
+        float d;
+        memcpy(&d, &values[i], sizeof(d));
+        pixels[i] = (d < lineWidth ? 0x0 : 0xFFFFFF00);
+    }
+}
+
+
+void colorIterations(const uint32_t* values, uint32_t* pixels, const unsigned int count, const iter_t nMax, const Palette palette) {
+    colorParallel(count, [&](const unsigned int first, const unsigned int last) {
+        switch(palette) {
+            case Palette::Polynomial:   colorPolynomial(values, pixels, first, last, nMax);    break;
+            case Palette::Cyclic:       colorCyclic(values, pixels, first, last);              break;
+            case Palette::BlackWhite:   colorBlackWhite(values, pixels, first, last);          break;
+        }
+    });
+}
+
+void colorDistances(const uint32_t* values, uint32_t* pixels, const unsigned int count, const double lineDetail) {
+    const float lineWidth = 1.0 / lineDetail;
+
+    colorParallel(count, [&](const unsigned int first, const unsigned int last) {
+        colorDistanceRun(values, pixels, first, last, lineWidth);
+    });
+}
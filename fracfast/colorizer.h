@@ -0,0 +1,52 @@
+#ifndef COLORIZER_H
+#define COLORIZER_H
+
+
+#include "types.h"
+
+#include <cstdint>
+#include <cstring>
+
+
+// The renderers don't write colors, but what a color is made from, so a frame can be recolored without calculating it again
+// Escape time: the iteration count + 1, 0 for points in the set, so points escaping right away (Julia sets) aren't 0
+// Distance estimation: the distance to the set divided by the width of the domain, as the bits of a float; 0 for points in the set
+
+// Iteration counts above this are stored as this; with ITERBITS=64, iter_t is wider than the buffers
+const uint32_t MAXPACKEDITERATIONS = 0xFFFFFFFE;
+
+inline uint32_t packIterations(const iter_t n, const iter_t nMax) {
+    if(n >= nMax)
+        return 0x0;
+
+    return (n < MAXPACKEDITERATIONS ? (uint32_t)n : MAXPACKEDITERATIONS) + 1;
+}
+
+// Only for points that escaped (value != 0)
+inline iter_t unpackIterations(const uint32_t value) {
+    return (iter_t)(value - 1);
+}
+
+inline uint32_t packDistance(const double d, const double width) {
+    const float f = d / width;
+    uint32_t value;
+    memcpy(&value, &f, sizeof(value));
+    return value;
+}
+
+
+enum class Palette {
+    Polynomial,  // Dark blue through orange, over the whole range of n
+    Cyclic,      // The same colors, repeating every 512 iterations
+    BlackWhite
+};
+
+
+// Colors count packed iteration counts to RGBA, on the threads of the library's thread pool; points in the set are black
+void colorIterations(const uint32_t* values, uint32_t* pixels, const unsigned int count, const iter_t nMax, const Palette palette);
+
+// Colors count packed distances; points closer to the set than the width of the domain divided by lineDetail are black, the others white
+void colorDistances(const uint32_t* values, uint32_t* pixels, const unsigned int count, const double lineDetail);
+
+
+#endif  // COLORIZER_H
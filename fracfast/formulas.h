@@ -0,0 +1,152 @@
+
+#ifndef FORMULAS_H
+#define FORMULAS_H
+
+
+#include "types.h"
+
+#include <cmath>
+
+
+// The iteration loops of the fractals, written once and generated for every formula, number type and coloring by Kernel below
+// A formula is a struct with the start of the orbit of a point, the step and the derivative of the step; a new fractal only needs a new one
+// Number is double or DoubleDouble; GMP has no operators, its loops are in borderTrace.cpp and mandelbrotGMP.cpp
+
+
+// The part of a number that's enough for comparisons with the bailout and epsilon
+inline double high(const double x) { return x; }
+inline double high(const DoubleDouble& x) { return x.hi; }
+
+
+// z -> z^2 + c; zSquared caches the squares of the parts of z
+struct Quadratic {
+    template<typename Number>
+    static inline void step(Number z[2], Number zSquared[2], const Number c[2]) {
+        z[1] = z[0] * z[1] * 2.0;
+        z[0] = zSquared[0] - zSquared[1];
+
+        z[0] = z[0] + c[0];
+        z[1] = z[1] + c[1];
+
+        zSquared[0] = z[0] * z[0];
+        zSquared[1] = z[1] * z[1];
+    }
+};
+
+// The point is c, the orbit starts at 0
+struct MandelbrotFormula : Quadratic {
+    template<typename Number>
+    inline void start(const Number p[2], Number z[2], Number c[2], Number dz[2]) const {
+        z[0] = 0; z[1] = 0;
+        c[0] = p[0]; c[1] = p[1];
+        dz[0] = 0; dz[1] = 0;
+    }
+
+    // dz = (2.0 * z * dz) + 1.0, with z before the step
+    template<typename Number>
+    static inline void derivative(Number dz[2], const Number z[2]) {
+        const Number dzNew = 2.0 * ((z[0] * dz[0]) - (z[1] * dz[1])) + 1.0;
+        dz[1] = 2.0 * ((z[0] * dz[1]) + (z[1] * dz[0]));
+        dz[0] = dzNew;
+    }
+};
+
+// The point is the start of the orbit, c is the same for all points
+struct JuliaFormula : Quadratic {
+    double c[2];
+
+    JuliaFormula(const double c0, const double c1) : c{c0, c1} {}
+
+    template<typename Number>
+    inline void start(const Number p[2], Number z[2], Number c[2], Number dz[2]) const {
+        z[0] = p[0]; z[1] = p[1];
+        c[0] = this->c[0]; c[1] = this->c[1];
+        dz[0] = 1.0; dz[1] = 0;
+    }
+
+    // dz = 2.0 * z * dz
+    template<typename Number>
+    static inline void derivative(Number dz[2], const Number z[2]) {
+        const Number dzNew = 2.0 * ((z[0] * dz[0]) - (z[1] * dz[1]));
+        dz[1] = 2.0 * ((z[0] * dz[1]) + (z[1] * dz[0]));
+        dz[0] = dzNew;
+    }
+};
+
+
+// Colorings of Kernel (colorizer.h packs what they return)
+struct EscapeTime {};  // Iterations before escaping
+struct Distance {};    // Exterior distance estimate
+
+
+// Exterior distance estimate from the final z and its derivative dz
+inline double estimateDistance(const double z[2], const double dz[2]) {
+    const double zMod = sqrt((z[0] * z[0]) + (z[1] * z[1])),
+                 dzMod = sqrt((dz[0] * dz[0]) + (dz[1] * dz[1]));
+    return (log(zMod * zMod) * zMod) / dzMod;
+}
+
+
+template<typename Formula, typename Number, typename Coloring>
+struct Kernel;
+
+// With periodicity checking (Brent): an orbit that comes back within epsilon (in both parts) of z at the last power of two iterations
+// is periodic, so it never escapes; epsilon 0 turns this off
+template<typename Formula, typename Number>
+struct Kernel<Formula, Number, EscapeTime> {
+    // Iterations of the orbit of p before escaping, nMax if it didn't; periodic is set when the check stopped it
+    static inline iter_t calc(const Formula& f, const Number p[2], const iter_t nMax, const double epsilon, bool& periodic) {
+        Number z[2], c[2], dz[2], zSquared[2], saved[2];
+        f.start(p, z, c, dz);
+        zSquared[0] = z[0] * z[0];
+        zSquared[1] = z[1] * z[1];
+        saved[0] = z[0];
+        saved[1] = z[1];
+
+        periodic = false;
+        iter_t n = 0;
+        for(; n < nMax && high(zSquared[0]) + high(zSquared[1]) <= 4.0; n++) {
+            f.step(z, zSquared, c);
+
+            if(fabs(high(z[0] - saved[0])) < epsilon && fabs(high(z[1] - saved[1])) < epsilon) {
+                periodic = true;
+                return nMax;
+            }
+            // z is z_(n + 1), saved when n + 1 is a power of two
+            if((n & (n + 1)) == 0) {
+                saved[0] = z[0];
+                saved[1] = z[1];
+            }
+        }
+
+        return n;
+    }
+};
+
+template<typename Formula, typename Number>
+struct Kernel<Formula, Number, Distance> {
+    // Estimated distance of p to the set; 0 if it didn't escape
+    static inline double calc(const Formula& f, const Number p[2], const iter_t nMax) {
+        Number z[2], c[2], dz[2], zSquared[2];
+        f.start(p, z, c, dz);
+        zSquared[0] = z[0] * z[0];
+        zSquared[1] = z[1] * z[1];
+
+        iter_t n = 0;
+        for(; n < nMax && high(zSquared[0]) + high(zSquared[1]) <= 4.0; n++) {
+            f.derivative(dz, z);
+            f.step(z, zSquared, c);
+        }
+
+        if(n == nMax)
+            return 0.0;
+
+        // Close to the set, the estimate doesn't need more than double precision
+        const double zHigh[2] = {high(z[0]), high(z[1])},
+                     dzHigh[2] = {high(dz[0]), high(dz[1])};
+        return estimateDistance(zHigh, dzHigh);
+    }
+};
+
+
+#endif  // FORMULAS_H
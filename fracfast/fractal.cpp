@@ -1,37 +1,33 @@
 
 #include "fractal.h"
 #include "borderTrace.cpp"
-
-#include <omp.h>
+#include "marianiSilver.cpp"
+#include "sharedBorderTrace.cpp"
 
 #include <cstring>
 #include <vector>
 
 
+
 Fractal::Fractal() : fractalType(Fractals::None), defaultDomain{-2, 2, 0} {
     nMax = 256;
-    lineDetail = 5000;
+    periodicity = DEFAULTPERIODICITY;
 }
 
 Fractal::Fractal(iter_t n) : fractalType(Fractals::None), defaultDomain{-2, 2, 0} {
     nMax = n;
-    lineDetail = 5000;
+    periodicity = DEFAULTPERIODICITY;
 }
 
 Fractal::Fractal(const Fractals f, const double rMin, const double rMax, const double iBase) : fractalType(f), defaultDomain{rMin, rMax, iBase} {
     nMax = 256;
-    lineDetail = 5000;
+    periodicity = DEFAULTPERIODICITY;
 }
 
 Fractal::~Fractal() {
 }
 
 
-void Fractal::setLineDetail(const double d) {
-    lineDetail = d;
-}
-
-
 void Fractal::getDefaultDomain(double dd[3]) const {
     for(int i = 0; i < 3; i++) {
         dd[i] = defaultDomain[i];
@@ -47,205 +43,283 @@ iter_t Fractal::getnMax() const {
     return nMax;
 }
 
+
+void Fractal::setPeriodicity(const double tolerance) {
+    periodicity = tolerance;
+}
+
+double Fractal::getPeriodicity() const {
+    return periodicity;
+}
+
+unsigned long Fractal::takePeriodicCount() const {
+    return periodicCount.take();
+}
+
 // void Fractal::changenMax(const int n) {
 //     // TODO: underflow detection!
 //     nMax += n;
 // }
 
 
-uint32_t* Fractal::render(const Domain& domain, const Resolution& res, const Range& range, void* data) const {
+void Fractal::calcPixels(const double* cr, const double* ci, const unsigned int count, const double pixelSize, const RenderOptions& options, uint32_t* colors) const {
+    double c[2];
+    for(unsigned int i = 0; i < count; i++) {
+        c[0] = cr[i];
+        c[1] = ci[i];
+        colors[i] = calcPixel(c, pixelSize, options);
+    }
+}
+
+
+uint32_t Fractal::calcPixel(const DoubleDouble c[2], const DoubleDouble& pixelSize, const RenderOptions& options) const {
+    const double d[2] = {c[0].hi, c[1].hi};
+    return calcPixel(d, pixelSize.hi, options);
+}
+
+
+// Cleared, so the pixels outside the range and the ones a cancelled render didn't reach are 0
+static uint32_t* newPixels(const Resolution& res) {
     uint32_t* pixels = new uint32_t[res.w * res.h];
-    memset(pixels, 0x0, res.w * res.h * sizeof(uint32_t));  // Init all pixel 0, because least significant byte is used for control flow in border trace
+    memset(pixels, 0x0, res.w * res.h * sizeof(uint32_t));
+    return pixels;
+}
+
+
+uint32_t* Fractal::render(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options) const {
+    uint32_t* pixels = newPixels(res);
 
     // HighPrecDomain d;
     // mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
     // mpf_set_d(d.rMin, domain.rMin); mpf_set_d(d.rMax, domain.rMax); mpf_set_d(d.iMin, domain.iMin); mpf_set_d(d.iMax, domain.iMax);
-    // calcScreenGMP(d, res, range, data, pixels);
+    // calcScreenGMP(d, res, range, options, pixels);
     // mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
-    calcScreen(domain, res, range, data, pixels);
+    calcScreen(domain, res, range, options, pixels);
 
     return pixels;
 }
 
 
-uint32_t* Fractal::threadedRender(const Domain& domain, const Resolution& res, const Range& range, void* data, int cores, int splits) const {
-    uint32_t* sharedPixels = new uint32_t[res.w * res.h];
-    memset(sharedPixels, 0x0, res.w * res.h * sizeof(uint32_t));  // Init all pixel 0, because least significant byte is used for control flow in border trace
-    
-    // int cores = omp_get_num_procs();
-    // int splits = 6;  // n splits leads to 2^n blocks
+uint32_t* Fractal::threadedRender(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores, int splits) const {
+    uint32_t* sharedPixels = newPixels(res);
 
-    // Split screen in smaller blocks
-    std::vector<Range> blocks = {range};
-    for(int i = 0; i < splits; i++) {
-        std::vector<Range> newBlocks;
-        for(auto& b : blocks) {
-            if(b.xMax - b.xMin > b.yMax - b.yMin) {  // If there are more pixels in the x axis, split it in 2
-                newBlocks.push_back({b.xMin, b.xMin + ((b.xMax - b.xMin) / 2), b.yMin, b.yMax});
-                newBlocks.push_back({b.xMin + ((b.xMax - b.xMin) / 2), b.xMax, b.yMin, b.yMax});
-            }
-            else {
-                newBlocks.push_back({b.xMin, b.xMax, b.yMin, b.yMin + ((b.yMax - b.yMin) / 2)});
-                newBlocks.push_back({b.xMin, b.xMax, b.yMin + ((b.yMax - b.yMin) / 2), b.yMax});
-            }
-        }
-        blocks = newBlocks;
-    }
+    renderTiles(range, [&](const Range& tile) { calcScreen(domain, res, tile, options, sharedPixels); }, cores, splits, options.cancel);
 
-    // Concurrently calculate all blocks
-    int lastBlock = 0;
-    int totalBlocks = 1 << splits;
-    #pragma omp parallel num_threads(cores)
-    {
-        while(true) {
-            int blocknum;
-            #pragma omp critical
-            {
-               blocknum = lastBlock;
-               lastBlock++;
-            }
-            if(blocknum >= totalBlocks)
-                break;
+    return sharedPixels;
+}
 
-            calcScreen(domain, res, blocks[blocknum], data, sharedPixels);
-        }
-    }
+
+uint32_t* Fractal::threadedRenderGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores, int splits) const {
+    uint32_t* sharedPixels = newPixels(res);
+
+    renderTiles(range, [&](const Range& tile) { calcScreenGMP(domain, res, tile, options, sharedPixels); }, cores, splits, options.cancel);
 
     return sharedPixels;
 }
 
+// Border trace with the pixel coordinates in double-double, so the fractal's calcPixel for DoubleDouble is used
+void Fractal::calcScreenDoubleDouble(const HighPrecDomain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels, uint8_t* calculated) const {
+    // Pixel size in GMP first, so it's not rounded before dividing
+    mpf_t ps;
+    mpf_init2(ps, mpf_get_prec(domain.rMin));
+    mpf_sub(ps, domain.rMax, domain.rMin);
+    mpf_div_ui(ps, ps, res.w);
+
+    // Set border trace struct up
+    BasicBorderTrace<DoubleDouble> bt;
+    bt.pixels = pixels; bt.pixelSize = DoubleDouble(ps); bt.options = &options; bt.calculated = calculated;
+    bt.rMin = DoubleDouble(domain.rMin); bt.iMax = DoubleDouble(domain.iMax);
+    bt.w = res.w; bt.h = res.h;
+    bt.xMin = r.xMin; bt.xMax = r.xMax; bt.yMin = r.yMin; bt.yMax = r.yMax; bt.dX = r.xMax - r.xMin; bt.dY = r.yMax - r.yMin;
+
+    mpf_clear(ps);
+
+    // Border trace
+    borderTrace(bt);
+}
 
-uint32_t Fractal::calcColor(const iter_t n) const {
-    uint32_t rgba = 0;
-    const double t = n / (double)nMax;
-    // const int t = n % 256;
+uint32_t* Fractal::threadedRenderDoubleDouble(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores, int splits) const {
+    uint32_t* sharedPixels = newPixels(res);
 
-    rgba |= (uint8_t)(9 * (1 - t) * t * t * t * 255) << 24;  // r
-    rgba |= (uint8_t)(15 * (1 - t) * (1 - t) * t * t * 255) << 16;  // g
-    rgba |= (uint8_t)(8.5 * (1 - t) * (1 - t) * (1 - t) * t * 255) << 8;  // b
+    renderTiles(range, [&](const Range& tile) { calcScreenDoubleDouble(domain, res, tile, options, sharedPixels); }, cores, splits, options.cancel);
 
-    return rgba;
+    return sharedPixels;
 }
 
-// Ugly coloring from thesis
-// Use nMax = 500 for graphics in thesis
-// uint32_t Fractal::calcColor(const iter_t n) const {
-//     double t = n / (double)nMax;
-//     return (uint32_t)(t * 256 * 256 * 256) << 8;
+uint32_t* Fractal::threadedRenderBruteforce(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores, int splits) const {
+    uint32_t* sharedPixels = newPixels(res);
 
-//     // This method was also used for the graphics in the thesis, it changes red->blue, blue->green and green->red, because it prettier
-//     uint32_t rgba = (uint32_t)(t * 256 * 256 * 256) << 8;
-//     uint8_t r = (rgba & 0xFF000000) >> 24;
-//     uint8_t g = (rgba & 0x00FF0000) >> 16;
-//     uint8_t b = (rgba & 0x0000FF00) >> 8;
-    
-//     return (r << 8) | (g << 24) | (b << 16);
-// }
+    renderTiles(range, [&](const Range& tile) { calcScreenBruteforce(domain, res, tile, options, sharedPixels); }, cores, splits, options.cancel);
 
-// Black-white coloring
-// uint32_t Fractal::calcColor(const iter_t n) const {
-//     if(n == nMax)
-//         return 0x0;
-//     else
-//         return 0xFFFFFFFF;
-// }
+    return sharedPixels;
+}
 
+uint32_t* Fractal::threadedRenderMarianiSilver(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores, int splits) const {
+    uint32_t* sharedPixels = newPixels(res);
 
-uint32_t* Fractal::threadedRenderGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, void* data, int cores, int splits) const {
-    uint32_t* sharedPixels = new uint32_t[res.w * res.h];
-    memset(sharedPixels, 0x0, res.w * res.h * sizeof(uint32_t));  // Init all pixel 0, because least significant byte is used for control flow in border trace
-    
-    // int cores = omp_get_num_procs();
-    // int splits = 6;  // n splits leads to 2^n blocks
-
-    // Split screen in smaller blocks
-    std::vector<Range> blocks = {range};
-    for(int i = 0; i < splits; i++) {
-        std::vector<Range> newBlocks;
-        for(auto& b : blocks) {
-            if(b.xMax - b.xMin > b.yMax - b.yMin) {  // If there are more pixels in the x axis, split it in 2
-                newBlocks.push_back({b.xMin, b.xMin + ((b.xMax - b.xMin) / 2), b.yMin, b.yMax});
-                newBlocks.push_back({b.xMin + ((b.xMax - b.xMin) / 2), b.xMax, b.yMin, b.yMax});
-            }
-            else {
-                newBlocks.push_back({b.xMin, b.xMax, b.yMin, b.yMin + ((b.yMax - b.yMin) / 2)});
-                newBlocks.push_back({b.xMin, b.xMax, b.yMin + ((b.yMax - b.yMin) / 2), b.yMax});
-            }
-        }
-        blocks = newBlocks;
-    }
+    renderTiles(range, [&](const Range& tile) { calcScreenMarianiSilver(domain, res, tile, options, sharedPixels); }, cores, splits, options.cancel);
 
-    // Concurrently calculate all blocks
-    int lastBlock = 0;
-    int totalBlocks = 1 << splits;
-    #pragma omp parallel num_threads(cores)
-    {
-        while(true) {
-            int blocknum;
-            #pragma omp critical
-            {
-               blocknum = lastBlock;
-               lastBlock++;
-            }
-            if(blocknum >= totalBlocks)
-                break;
+    return sharedPixels;
+}
 
-            calcScreenGMP(domain, res, blocks[blocknum], data, sharedPixels);
-        }
+uint32_t* Fractal::threadedRenderShared(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores) const {
+    uint32_t* pixels = newPixels(res);
+    if(range.xMax <= range.xMin || range.yMax <= range.yMin)
+        return pixels;
+    if(cores <= ALLTHREADS)
+        cores = threadPool().size();
+
+    SharedBorderTrace st;
+    st.pixels = pixels;
+    st.state.reset(new std::atomic<uint8_t>[res.w * res.h]());
+    st.queue.reset(new std::atomic<unsigned int>[(range.xMax - range.xMin) * (range.yMax - range.yMin)]());
+    st.head = 0; st.tail = 0; st.pending = 0; st.idle = 0;
+    st.rMin = domain.rMin; st.iMax = domain.iMax; st.pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
+    st.w = res.w; st.r = range; st.options = &options;
+
+    // Only the edge of the whole range; a range of one row or column would have its pixels in it twice
+    std::vector<unsigned int> edge;
+    edge.reserve(2 * ((range.xMax - range.xMin) + (range.yMax - range.yMin)));
+    const auto addEdge = [&](const unsigned int pixel) {
+        if(markQueued(st, pixel))
+            edge.push_back(pixel);
+    };
+    for(unsigned int x = range.xMin; x < range.xMax; x++) {
+        addEdge(range.yMin * res.w + x);
+        addEdge((range.yMax - 1) * res.w + x);
+    }
+    for(unsigned int y = range.yMin + 1; y < range.yMax - 1; y++) {
+        addEdge(y * res.w + range.xMin);
+        addEdge(y * res.w + range.xMax - 1);
     }
+    push(st, edge.data(), edge.size());
 
-    return sharedPixels;
+    threadPool().run(cores, [&](const unsigned int) { sharedBorderTrace(st); });
+    if(isCancelled(options.cancel))
+        return pixels;  // Filling now would flood the unfinished parts with the colors of the border
+
+    // Every row is filled from the left, so the rows can be filled in parallel
+    threadPool().run(cores, [&](const unsigned int worker) {
+        for(unsigned int y = range.yMin + worker; y < range.yMax; y += cores)
+            for(unsigned int x = range.xMin + 1; x < range.xMax; x++)
+                if(!(st.state[y * res.w + x].load(std::memory_order_relaxed) & COLORED))
+                    pixels[y * res.w + x] = pixels[y * res.w + x - 1];
+    });
+
+    return pixels;
 }
 
-uint32_t* Fractal::threadedRenderBruteforce(const Domain& domain, const Resolution& res, const Range& range, void* data, int cores, int splits) const {
-    uint32_t* sharedPixels = new uint32_t[res.w * res.h];
-    memset(sharedPixels, 0x0, res.w * res.h * sizeof(uint32_t));  // Init all pixel 0, because least significant byte is used for control flow in border trace
-    
-    // Split screen in smaller blocks
-    std::vector<Range> blocks = {range};
-    for(int i = 0; i < splits; i++) {
-        std::vector<Range> newBlocks;
-        for(auto& b : blocks) {
-            if(b.xMax - b.xMin > b.yMax - b.yMin) {  // If there are more pixels in the x axis, split it in 2
-                newBlocks.push_back({b.xMin, b.xMin + ((b.xMax - b.xMin) / 2), b.yMin, b.yMax});
-                newBlocks.push_back({b.xMin + ((b.xMax - b.xMin) / 2), b.xMax, b.yMin, b.yMax});
-            }
-            else {
-                newBlocks.push_back({b.xMin, b.xMax, b.yMin, b.yMin + ((b.yMax - b.yMin) / 2)});
-                newBlocks.push_back({b.xMin, b.xMax, b.yMin + ((b.yMax - b.yMin) / 2), b.yMax});
+
+
+// Every step-th pixel in both directions is calculated in a pass
+static const unsigned int PASSSTEPS[] = {4, 2, 1};
+static const unsigned int PASSES = sizeof(PASSSTEPS) / sizeof(PASSSTEPS[0]);
+
+// Runs the passes of a progressive render. renderPass(step, passRes, passRange, pass, calculated) border traces the pixels at multiples of step,
+// which are pixel (x / step, y / step) in pass, a screen of passRes with the domain of the full screen
+template<typename PassRenderer>
+static uint32_t* progressivePasses(const Resolution& res, const Range& range, const PassRenderer& renderPass, const PassFunction& passDone, const CancelToken* cancel) {
+    uint32_t* const shown = new uint32_t[res.w * res.h];  // The last coarse pass, scaled up
+    memset(shown, 0x0, res.w * res.h * sizeof(uint32_t));
+
+    uint32_t* prevPass = nullptr;
+    std::vector<uint8_t> prevCalculated;
+    Resolution prevRes = {0, 0};
+    Range prevRange = {0, 0, 0, 0};
+    unsigned int prevStep = 0;
+
+    for(unsigned int i = 0; i < PASSES; i++) {
+        const unsigned int step = PASSSTEPS[i];
+        const Resolution passRes = {(res.w + step - 1) / step, (res.h + step - 1) / step};
+        const Range passRange = {range.xMin / step, (range.xMax + step - 1) / step, range.yMin / step, (range.yMax + step - 1) / step};
+
+        // Cleared for the pixels outside the range, as the last pass is returned
+        uint32_t* const pass = newPixels(passRes);
+        std::vector<uint8_t> calculated(passRes.w * passRes.h, 0);
+
+        // The samples the last pass calculated are marked calculated, so the border trace doesn't calculate them again
+        // Filled pixels are only a guess, so those are calculated
+        if(prevPass != nullptr) {
+            const unsigned int ratio = prevStep / step;
+            for(unsigned int y = prevRange.yMin; y < prevRange.yMax; y++) {
+                for(unsigned int x = prevRange.xMin; x < prevRange.xMax; x++) {
+                    if(prevCalculated[y * prevRes.w + x]) {
+                        const unsigned int sample = (y * ratio) * passRes.w + (x * ratio);
+                        pass[sample] = prevPass[y * prevRes.w + x];
+                        calculated[sample] = 1;
+                    }
+                }
             }
+            delete[] prevPass;
         }
-        blocks = newBlocks;
-    }
 
-    // Concurrently calculate all blocks
-    int lastBlock = 0;
-    int totalBlocks = 1 << splits;
-    #pragma omp parallel num_threads(cores)
-    {
-        while(true) {
-            int blocknum;
-            #pragma omp critical
-            {
-               blocknum = lastBlock;
-               lastBlock++;
-            }
-            if(blocknum >= totalBlocks)
-                break;
+        renderPass(step, passRes, passRange, pass, calculated.data());
+        prevPass = pass; prevCalculated.swap(calculated); prevRes = passRes; prevRange = passRange; prevStep = step;
 
-            calcScreenBruteforce(domain, res, blocks[blocknum], data, sharedPixels);
+        if(isCancelled(cancel)) {
+            if(i > 0)
+                break;
 
+            // No pass finished, and the zeros of shown would be drawn as the set
+            delete[] pass;
+            delete[] shown;
+            return nullptr;
         }
+        if(step == 1) {
+            delete[] shown;
+            return pass;
+        }
+
+        for(unsigned int y = range.yMin; y < range.yMax; y++)
+            for(unsigned int x = range.xMin; x < range.xMax; x++)
+                shown[y * res.w + x] = pass[(y / step) * passRes.w + (x / step)];
+        if(passDone)
+            passDone(shown, step);
     }
 
-    return sharedPixels;
+    delete[] prevPass;
+    return shown;
+}
+
+uint32_t* Fractal::progressiveRender(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, const PassFunction& passDone, int cores, int splits) const {
+    const double pixelSize = (domain.rMax - domain.rMin) / res.w;
+
+    return progressivePasses(res, range, [&](const unsigned int step, const Resolution& passRes, const Range& passRange, uint32_t* pass, uint8_t* calculated) {
+        // The screen of the pass starts at the same point, with pixels step times as large
+        const Domain passDomain = {domain.rMin, domain.rMin + (passRes.w * step * pixelSize), domain.iMax - (passRes.h * step * pixelSize), domain.iMax};
+        renderTiles(passRange, [&](const Range& tile) { calcScreen(passDomain, passRes, tile, options, pass, calculated); }, cores, splits, options.cancel);
+    }, passDone, options.cancel);
 }
 
+uint32_t* Fractal::progressiveRenderDoubleDouble(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, const PassFunction& passDone, int cores, int splits) const {
+    HighPrecDomain passDomain;
+    mpf_t passWidth;
+    const mp_bitcnt_t prec = mpf_get_prec(domain.rMin);
+    mpf_init2(passDomain.rMin, prec); mpf_init2(passDomain.rMax, prec); mpf_init2(passDomain.iMin, prec); mpf_init2(passDomain.iMax, prec);
+    mpf_init2(passWidth, prec);
+    mpf_set(passDomain.rMin, domain.rMin); mpf_set(passDomain.iMax, domain.iMax);
+
+    uint32_t* const pixels = progressivePasses(res, range, [&](const unsigned int step, const Resolution& passRes, const Range& passRange, uint32_t* pass, uint8_t* calculated) {
+        // passWidth = pixelSize * step * passRes.w, in GMP so the pixels of the passes line up
+        mpf_sub(passWidth, domain.rMax, domain.rMin);
+        mpf_div_ui(passWidth, passWidth, res.w);
+        mpf_mul_ui(passWidth, passWidth, step);
+        mpf_mul_ui(passDomain.iMin, passWidth, passRes.h);
+        mpf_sub(passDomain.iMin, domain.iMax, passDomain.iMin);
+        mpf_mul_ui(passWidth, passWidth, passRes.w);
+        mpf_add(passDomain.rMax, domain.rMin, passWidth);
+
+        renderTiles(passRange, [&](const Range& tile) { calcScreenDoubleDouble(passDomain, passRes, tile, options, pass, calculated); }, cores, splits, options.cancel);
+    }, passDone, options.cancel);
+
+    mpf_clears(passDomain.rMin, passDomain.rMax, passDomain.iMin, passDomain.iMax, passWidth, NULL);
+    return pixels;
+}
 
-inline uint32_t* Fractal::render(const Domain& domain, const Resolution& res, void* data) const {
-    return render(domain, res, {0, res.w, 0, res.h}, data);
+inline uint32_t* Fractal::render(const Domain& domain, const Resolution& res, const RenderOptions& options) const {
+    return render(domain, res, {0, res.w, 0, res.h}, options);
 }
 
-inline uint32_t* Fractal::threadedRender(const Domain& domain, const Resolution& res, void* data, int cores, int splits) const {
-    return threadedRender(domain, res, {0, res.w, 0, res.h}, data, cores, splits);
+inline uint32_t* Fractal::threadedRender(const Domain& domain, const Resolution& res, const RenderOptions& options, int cores, int splits) const {
+    return threadedRender(domain, res, {0, res.w, 0, res.h}, options, cores, splits);
 }
@@ -5,15 +5,30 @@
 
 #include "types.h"
 #include "borderTrace.h"
+#include "colorizer.h"
+#include "renderOptions.h"
+#include "scheduler.h"
 
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <array>
+#include <vector>
 
 
+struct SharedBorderTrace;
+
 typedef std::list<std::array<double, 2>> Orbit;
 typedef std::array<double, 2> Point;
 
+// Periodicity tolerance relative to the pixel size (Fractal::setPeriodicity)
+// Far below the pixel size, so an orbit has to have settled on its cycle; points escaping slowly close to the set don't come back that close
+// At 1e-3 a few pixels of the home view at nMax = 10000 were wrongly in the set, at 1e-4 none, and it's hardly slower
+const double DEFAULTPERIODICITY = 1e-4;
+
+// Gets the whole screen after a coarse pass of a progressive render, with every sample drawn as a step x step block
+typedef std::function<void(const uint32_t* pixels, const unsigned int step)> PassFunction;
+
 enum class Fractals {
     None,
     Mandelbrot,
@@ -28,59 +43,91 @@ class Fractal {
         Fractal(const Fractals f, const double rMin, const double rMax, const double iBase);
         virtual ~Fractal();
 
-        void setLineDetail(const double d);
-
         void getDefaultDomain(double dd[3]) const;
 
         void setnMax(const iter_t n);
         iter_t getnMax() const;
         // void changenMax(const int n);
 
-        virtual void calcScreen(const Domain& domain, const Resolution& res, const Range& range, void* data, uint32_t* pixels) const = 0;
-        virtual void calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, void* data, uint32_t* pixels) const = 0;
-        virtual void calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const = 0;
-
-        uint32_t* render(const Domain& domain, const Resolution& res, const Range& range, void* data) const;
-        uint32_t* threadedRender(const Domain& domain, const Resolution& res, const Range& range, void* data, int cores = 8, int splits = 7) const;
-        uint32_t* threadedRenderGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, void* data, int cores = 8, int splits = 7) const;
-        uint32_t* threadedRenderBruteforce(const Domain& domain, const Resolution& res, const Range& range, void* data, int cores = 8, int splits = 7) const;
+        // Periodicity checking (kernels.h) with epsilon = tolerance * pixel size, so it gets stricter when zooming in; 0 turns it off
+        void setPeriodicity(const double tolerance);
+        double getPeriodicity() const;
+        // Points found periodic since the last call, by all threads; read after a frame to report it
+        unsigned long takePeriodicCount() const;
+
+        // Border traces range of pixels; calculated is passed on to the border trace (borderTrace.h)
+        virtual void calcScreen(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, uint32_t* pixels, uint8_t* calculated = nullptr) const = 0;
+        virtual void calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, uint32_t* pixels) const = 0;
+        virtual void calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const = 0;
+
+        uint32_t* render(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options) const;
+        uint32_t* threadedRender(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
+        uint32_t* threadedRenderGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
+        uint32_t* threadedRenderBruteforce(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
+        // Border trace in double-double precision, for zooms too deep for doubles but not yet needing GMP
+        void calcScreenDoubleDouble(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, uint32_t* pixels, uint8_t* calculated = nullptr) const;
+        uint32_t* threadedRenderDoubleDouble(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
+        // One border trace over the whole range instead of one per tile, with all cores taking pixels from the same queue (sharedBorderTrace.cpp)
+        // Less work than threadedRender, because only the edge of the range is calculated, and every pixel only once
+        // Used by the viewer when it renders without passes; progressive renders still trace per tile
+        uint32_t* threadedRenderShared(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores = ALLTHREADS) const;
+        // Mariani-Silver: calculates the edge of a rectangle, fills it if the whole edge has one value, splits it in two and does the same with both halves otherwise
+        void calcScreenMarianiSilver(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, uint32_t* pixels) const;
+        uint32_t* threadedRenderMarianiSilver(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
+        // Render at 1/16, then 1/4, then full pixel density; passDone is called after the coarse passes, the last pass is returned
+        // The samples of a pass are reused by the next one. When cancelled, the last finished pass is returned, or nullptr if the first pass didn't finish
+        uint32_t* progressiveRender(const Domain& domain, const Resolution& res, const Range& range, const RenderOptions& options, const PassFunction& passDone, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
+        uint32_t* progressiveRenderDoubleDouble(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, const PassFunction& passDone, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
         // To support Range as optional argument, because can't set range to values in res in C++
-        inline uint32_t* render(const Domain& domain, const Resolution& res, void* data) const;
-        inline uint32_t* threadedRender(const Domain& domain, const Resolution& res, void* data, int cores = 8, int splits = 7) const;
+        inline uint32_t* render(const Domain& domain, const Resolution& res, const RenderOptions& options) const;
+        inline uint32_t* threadedRender(const Domain& domain, const Resolution& res, const RenderOptions& options, int cores = ALLTHREADS, int splits = AUTOSPLITS) const;
 
         // virtual uint32_t calcPixel(const double z0[2]) const = 0;
-        virtual uint32_t calcPixel(const double z0[2], void* data) const = 0;
+        // pixelSize is the distance between the points of the screen, for the periodicity tolerance
+        virtual uint32_t calcPixel(const double z0[2], const double pixelSize, const RenderOptions& options) const = 0;
+        // Calculates count points at once; fractals with a vector kernel override this
+        virtual void calcPixels(const double* cr, const double* ci, const unsigned int count, const double pixelSize, const RenderOptions& options, uint32_t* colors) const;
+        // Fractals without a double-double iteration fall back to calcPixel in double precision
+        virtual uint32_t calcPixel(const DoubleDouble c[2], const DoubleDouble& pixelSize, const RenderOptions& options) const;
 
         // virtual void deepenRender(uint32_t* pixels, const Domain& domain, const Resolution& res) const = 0;
 
-        uint32_t calcColor(const iter_t n) const;
-
         virtual void calcOrbit(const double c[2], Orbit& points) const = 0;
 
         const Fractals fractalType;
 
 
     protected:
-        // Width for exterior distance coloring. Higher value is more detail (thinner line)
-        double lineDetail;
-        
         iter_t nMax;
-
-        // Border tracing functions
-        uint32_t getColor(BorderTrace& bt, const unsigned int pixel) const;
-        uint32_t getColor(BorderTrace& bt, const unsigned int x, const unsigned int y) const;
-        uint32_t getColor(BorderTrace& bt, const unsigned int pixel[2]) const;
-        void addQueue(BorderTrace& bt, const unsigned int pixel) const;
-        void edgeInQueue(BorderTrace& bt) const;
-        void checkNeighbors(BorderTrace& bt, const unsigned int pixel) const;
-        void fillEmptyPixels(BorderTrace& bt) const;
-
+        double periodicity;  // Tolerance relative to the pixel size
+        mutable Counter periodicCount;
+
+        // Border tracing functions, instantiated for double, DoubleDouble and mpf_t in borderTrace.cpp
+        // pixel is the index in the screen, s the index in the state of the tile (borderTrace.h)
+        template<typename Number>
+        void borderTrace(BasicBorderTrace<Number>& bt) const;
+        // In batches for the vector kernels
+        void borderTrace(BorderTrace& bt) const;
+        template<typename Number>
+        uint32_t getColor(BasicBorderTrace<Number>& bt, const unsigned int pixel, const unsigned int s) const;
+        template<typename Number>
+        void addQueue(BasicBorderTrace<Number>& bt, const unsigned int pixel, const unsigned int s) const;
+        template<typename Number>
+        void edgeInQueue(BasicBorderTrace<Number>& bt) const;
+        template<typename Number>
+        void calcEdge(BasicBorderTrace<Number>& bt, const std::vector<unsigned int>& edge) const;
+        void calcEdge(BorderTrace& bt, const std::vector<unsigned int>& edge) const;
+        template<typename Number>
+        void checkNeighbors(BasicBorderTrace<Number>& bt, const unsigned int pixel) const;
+        template<typename Number>
+        void fillEmptyPixels(BasicBorderTrace<Number>& bt) const;
+
+        // Run by every thread of threadedRenderShared
+        void sharedBorderTrace(SharedBorderTrace& st) const;
+
+        // GMP pixels; getColor of the other number types calls calcPixel instead
         uint32_t calcGMPPixel(HighPrecBorderTrace& bt) const;
-        uint32_t getColor(HighPrecBorderTrace& bt, const unsigned int pixel) const;
-        void addQueue(HighPrecBorderTrace& bt, const unsigned int pixel) const;
-        void edgeInQueue(HighPrecBorderTrace& bt) const;
-        void checkNeighbors(HighPrecBorderTrace& bt, const unsigned int pixel) const;
-        void fillEmptyPixels(HighPrecBorderTrace& bt) const;
+        uint32_t getColor(HighPrecBorderTrace& bt, const unsigned int pixel, const unsigned int s) const;
 
 
     private:
@@ -0,0 +1,232 @@
+// Generates bulbTable.cpp, the discs inside the hyperbolic components of the Mandelbrot set used by inBulbs (shapes.h)
+// Not part of the library; build and run it with 'make bulbs'
+//
+// 1. Every point of a grid over the upper half of the set that doesn't escape is iterated until its orbit settles on an
+//    attracting cycle, whose period is the period of the component the point is in
+// 2. Newton's method on f_c^p(0) = 0 gives the nucleus (center) of that component
+// 3. The boundary is traced by solving f_c^p(z) = z, (f_c^p)'(z) = e^(i * theta) for (z, c), continuing from the nucleus
+//    (z = 0, multiplier 0) outwards; the disc is the largest disc around the nucleus or the centroid of the boundary inside it
+// 4. Every disc is checked by iterating points on its edge, which have to stay bounded
+
+#include <complex>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+
+typedef std::complex<double> Complex;
+
+
+static const int MAXPERIOD = 24;
+static const double MINRADIUS = 1e-3;   // Smaller discs hardly ever contain a pixel that isn't calculated anyway
+static const double GRIDSTEP = 1e-3;    // Finds every component with an inscribed disc of radius MINRADIUS
+static const int SETTLE = 4000;         // Iterations before looking for a cycle
+static const int SAMPLES = 512;         // Points on the boundary of a component
+static const int STEPS = 64;            // Continuation steps from the nucleus to the boundary
+static const double SAFETY = 0.99;      // The disc is shrunk by this, for the parts of the boundary between the samples
+
+
+struct Bulb {
+    Complex center;
+    double radius;
+    int period;
+};
+
+
+static bool inCardioid(const Complex c) {
+    const double q = std::norm(c - 0.25);
+    return q * (q + (c.real() - 0.25)) < c.imag() * c.imag() * 0.25;
+}
+
+static bool in2Bulb(const Complex c) {
+    return std::norm(c + 1.0) < 0.0625;
+}
+
+
+// Period of the attracting cycle of c, or 0 if it escapes or doesn't settle
+static int cyclePeriod(const Complex c) {
+    Complex z = 0;
+    for(int n = 0; n < SETTLE; n++) {
+        z = z * z + c;
+        if(std::norm(z) > 4.0)
+            return 0;
+    }
+
+    const Complex w = z;
+    for(int p = 1; p <= MAXPERIOD; p++) {
+        z = z * z + c;
+        if(std::abs(z - w) < 1e-9)
+            return p;
+    }
+
+    return 0;
+}
+
+// Newton's method on f_c^p(0) = 0, from c; false if it doesn't converge to a nucleus of period p
+static bool nucleus(Complex& c, const int p) {
+    for(int it = 0; it < 64; it++) {
+        Complex z = 0, dz = 0;
+        for(int k = 0; k < p; k++) {
+            dz = 2.0 * z * dz + 1.0;
+            z = z * z + c;
+        }
+
+        const Complex step = z / dz;
+        c -= step;
+        if(!std::isfinite(c.real()) || !std::isfinite(c.imag()))
+            return false;
+        if(std::abs(step) < 1e-15 * std::max(1.0, std::abs(c)))
+            break;
+    }
+
+    // 0 has to come back after p iterations, but not before
+    Complex z = 0;
+    for(int k = 1; k <= p; k++) {
+        z = z * z + c;
+        if(k < p && std::abs(z) < 1e-8)
+            return false;
+    }
+    return std::abs(z) < 1e-10;
+}
+
+// Solves f_c^p(z) = z and (f_c^p)'(z) = lambda with Newton's method, from (z, c)
+static bool cycleWithMultiplier(Complex& z0, Complex& c, const int p, const Complex lambda) {
+    for(int it = 0; it < 32; it++) {
+        // Derivatives of z_k with respect to z0 (a) and c (b), and of a with respect to z0 (az) and c (ac)
+        Complex z = z0, a = 1, b = 0, az = 0, ac = 0;
+        for(int k = 0; k < p; k++) {
+            az = 2.0 * (a * a + z * az);
+            ac = 2.0 * (b * a + z * ac);
+            b = 2.0 * z * b + 1.0;
+            a = 2.0 * z * a;
+            z = z * z + c;
+        }
+
+        // [a - 1, b; az, ac] * [dz0, dc] = -[z - z0, a - lambda]
+        const Complex f1 = z - z0, f2 = a - lambda;
+        const Complex det = (a - 1.0) * ac - b * az;
+        if(std::abs(det) == 0.0)
+            return false;
+        const Complex dz0 = -(ac * f1 - b * f2) / det,
+                      dc = -((a - 1.0) * f2 - az * f1) / det;
+        z0 += dz0;
+        c += dc;
+
+        if(!std::isfinite(c.real()) || !std::isfinite(c.imag()))
+            return false;
+        // Relative, |z0| gets up to 2 and rounding stops the steps around 1e-15 there
+        if(std::abs(dc) < 1e-13 * std::max(1.0, std::abs(c)) && std::abs(dz0) < 1e-13 * std::max(1.0, std::abs(z0)))
+            return true;
+    }
+
+    return false;
+}
+
+// Points on the boundary of the component of the nucleus c0; false if a point could not be found
+static bool boundary(const Complex c0, const int p, std::vector<Complex>& points) {
+    points.clear();
+    for(int s = 0; s < SAMPLES; s++) {
+        // Half a sample off, so the root (multiplier 1), where the system is singular, isn't sampled
+        const double theta = 2.0 * M_PI * (s + 0.5) / SAMPLES;
+        Complex z = 0, c = c0;
+        for(int step = 1; step <= STEPS; step++)
+            if(!cycleWithMultiplier(z, c, p, std::polar((double)step / STEPS, theta)))
+                return false;
+        points.push_back(c);
+    }
+
+    return true;
+}
+
+static double insideRadius(const Complex center, const std::vector<Complex>& points) {
+    double r = HUGE_VAL, gap = 0;
+    for(unsigned int i = 0; i < points.size(); i++) {
+        r = std::min(r, std::abs(points[i] - center));
+        gap = std::max(gap, std::abs(points[(i + 1) % points.size()] - points[i]));
+    }
+
+    return (r - gap / 2) * SAFETY;
+}
+
+// Points on the edge of the disc stay bounded
+static bool bounded(const Bulb& b) {
+    for(int s = 0; s < 64; s++) {
+        const Complex c = b.center + std::polar(b.radius, 2.0 * M_PI * s / 64);
+        Complex z = 0;
+        for(int n = 0; n < 100000; n++) {
+            z = z * z + c;
+            if(std::norm(z) > 4.0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main() {
+    // Nuclei of the upper half; the lower half is the mirror image
+    std::vector<Complex> nuclei;
+    std::vector<int> periods;
+    for(double ci = 0; ci <= 1.2; ci += GRIDSTEP)
+        for(double cr = -2.0; cr <= 0.5; cr += GRIDSTEP) {
+            const Complex c(cr, ci);
+            if(inCardioid(c) || in2Bulb(c))
+                continue;
+
+            const int p = cyclePeriod(c);
+            if(p < 3)
+                continue;
+
+            Complex n = c;
+            if(!nucleus(n, p))
+                continue;
+            n = Complex(n.real(), std::fabs(n.imag()));
+
+            bool known = false;
+            for(unsigned int i = 0; i < nuclei.size() && !known; i++)
+                known = periods[i] == p && std::abs(nuclei[i] - n) < 1e-9;
+            if(!known) {
+                nuclei.push_back(n);
+                periods.push_back(p);
+            }
+        }
+
+    std::vector<Bulb> bulbs;
+    std::vector<Complex> points;
+    for(unsigned int i = 0; i < nuclei.size(); i++) {
+        if(!boundary(nuclei[i], periods[i], points))
+            continue;
+
+        Complex centroid = 0;
+        for(auto& point : points)
+            centroid += point;
+        centroid /= (double)points.size();
+
+        Bulb b = {nuclei[i], insideRadius(nuclei[i], points), periods[i]};
+        if(insideRadius(centroid, points) > b.radius)
+            b = {centroid, insideRadius(centroid, points), periods[i]};
+        if(b.radius < MINRADIUS || !bounded(b))
+            continue;
+
+        // On the real axis the center is exactly real, so the disc is its own mirror image
+        if(std::fabs(b.center.imag()) < 1e-12)
+            b.center = Complex(b.center.real(), 0.0);
+        bulbs.push_back(b);
+    }
+
+    // Largest first, as those contain the most points
+    std::sort(bulbs.begin(), bulbs.end(), [](const Bulb& a, const Bulb& b) { return a.radius > b.radius; });
+
+    printf("// Generated by genBulbs.cpp (make bulbs), don't edit\n");
+    printf("// Discs inside the hyperbolic components of period 3 to %d with a radius of at least %g, of the upper half of the set\n", MAXPERIOD, MINRADIUS);
+    printf("// The cardioid and the period 2 bulb are not in it, as inCardioid and in2Bulb test those exactly\n\n");
+    printf("// center r, center i, radius, period\n");
+    printf("static const Bulb BULBTABLE[] = {\n");
+    for(auto& b : bulbs)
+        printf("    {%.17g, %.17g, %.17g, %d},\n", b.center.real(), b.center.imag(), b.radius, b.period);
+    printf("};\n");
+
+    return 0;
+}
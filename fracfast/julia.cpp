@@ -6,9 +6,6 @@
 #include <cstdint>
 
 
-static double LINEWIDTH;
-
-
 Julia::Julia() : Fractal(Fractals::Julia, -2.0, 2.0, 0.0) {
     // c[0] = 0.4;
     // c[1] = 0.325;
@@ -42,11 +39,11 @@ void Julia::getC(double& c0, double& c1) const {
 }
 
 
-void Julia::calcScreen(const Domain& domain, const Resolution& res, const Range& r, const double _c[2], void* data, uint32_t* pixels) {
+void Julia::calcScreen(const Domain& domain, const Resolution& res, const Range& r, const double _c[2], const RenderOptions& options, uint32_t* pixels) {
     c[0] = _c[0];
     c[1] = _c[1];
 
-    calcScreen(domain, res, r, data, pixels);
+    calcScreen(domain, res, r, options, pixels);
 }
 
 
@@ -56,134 +53,65 @@ void Julia::calcScreen(const Domain& domain, const Resolution& res, const Range&
 
 
 // TODO: Fix distance coloring Julia sets
-inline uint32_t Julia::colorDistance(const double d) const {
-    if(d < LINEWIDTH)
-        return 0x0;
-    else
-        return 0xFFFFFFFF;
-}
-
-// Exterior distance estimation
-inline uint32_t Julia::calcDistance(const double z0[2]) const {
-    double z[2] = {z0[0], z0[1]},
-           zSquared[2] = {z0[0] * z0[0], z0[1] * z0[1]},
-           dz[2] = {1.0, 0.0},
-           dzNew;
-
-    unsigned int n = 0;
-    for(; n < nMax && zSquared[0] + zSquared[1] <= 4.0; n++) {
-        //dz = (2.0 * z * dz);
-        dzNew = 2.0 * ((z[0] * dz[0]) - (z[1] * dz[1]));
-        dz[1] = 2.0 * ((z[0] * dz[1]) + (z[1] * dz[0]));
-        dz[0] = dzNew;
-
-        // z = z^2 + c
-        z[1] = z[0] * z[1] * 2.0;
-        z[0] = zSquared[0] - zSquared[1];
-        z[0] += c[0];
-        z[1] += c[1];
-
-        zSquared[0] = z[0] * z[0];
-        zSquared[1] = z[1] * z[1];
-    }
-
-    if(n == nMax)
-        return 0x0;
-
-    // Calculate modulus
-    z[0] = sqrt(zSquared[0] + zSquared[1]);
-    dz[0] = sqrt((dz[0] * dz[0]) + (dz[1] * dz[1]));
-    return colorDistance((log(z[0] * z[0]) * z[0]) / dz[0]);
+// Exterior distance estimation; 0 for points in the set
+inline double Julia::calcDistance(const double z0[2]) const {
+    return Kernel<JuliaFormula, double, Distance>::calc(JuliaFormula(c[0], c[1]), z0, nMax);
 }
 
-void Julia::calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
+void Julia::calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
     const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
 
-    LINEWIDTH = (domain.rMax - domain.rMin) / lineDetail;
-
     // Normal calculation
     double z[2];
     for(unsigned int y = r.yMin; y < r.yMax; y++) {
         z[1] = domain.iMax - (y * pixelSize);
 
         for(unsigned int x = r.xMin; x < r.xMax; x++) {
+            // Every pixel, as a row is slow with a high nMax without a vector kernel
+            if(isCancelled(options.cancel))
+                return;
+
             z[0] = domain.rMin + (x * pixelSize);
-            pixels[y * res.w + x] = calcDistance(z);
+            pixels[y * res.w + x] = packDistance(calcDistance(z), domain.rMax - domain.rMin);
         }
     }
-
-    // return pixels;
-    return;
-
-    // Prevent error
-    z[0] = *(double*)data;
 }
 
 
-uint32_t Julia::calcPixel(const double z0[2], void* data) const {
-    double zSquared[2] = {z0[0] * z0[0], z0[1] * z0[1]};
-
-    // Points outside radius 2 are not part of the set, so shouldn't be black
-    if(zSquared[0] + zSquared[1] > 4.0)
-        return calcColor(1);
-
-    double z[2] = {z0[0], z0[1]};
-    unsigned int n = 0;
-    for(; n < nMax && zSquared[0] + zSquared[1] <= 4.0; n++) {
-        z[1] = z[0] * z[1] * 2.0;
-        z[0] = zSquared[0] - zSquared[1];
-
-        z[0] += c[0];
-        z[1] += c[1];
-
-        zSquared[0] = z[0] * z[0];
-        zSquared[1] = z[1] * z[1];
-    }
-
-    return calcColor(n);
+uint32_t Julia::calcPixel(const double z0[2], const double pixelSize, const RenderOptions&) const {
+    bool periodic;  // Caught in an attracting cycle, so it never escapes
+    const iter_t n = Kernel<JuliaFormula, double, EscapeTime>::calc(JuliaFormula(c[0], c[1]), z0, nMax, periodicity * pixelSize, periodic);
+    if(periodic)
+        periodicCount.add(1);
 
-    // Prevent error
-    n = *(uint32_t*)data;
+    return packIterations(n, nMax);
 }
 
 
 // With border trace and caching
-void Julia::calcScreen(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
+void Julia::calcScreen(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels, uint8_t* calculated) const {
     const double ps = (domain.rMax - domain.rMin) / (double)res.w;
     const unsigned int dX = r.xMax - r.xMin,
                        dY = r.yMax - r.yMin;
 
     // Set border trace struct up
     BorderTrace bt;
-    bt.pixels = pixels; bt.pixelSize = ps; bt.data = nullptr;
+    bt.pixels = pixels; bt.pixelSize = ps; bt.options = &options; bt.calculated = calculated;
     bt.rMin = domain.rMin; bt.iMax = domain.iMax;
     bt.w = res.w; bt.h = res.h;
     bt.xMin = r.xMin; bt.xMax = r.xMax; bt.yMin = r.yMin; bt.yMax = r.yMax; bt.dX = dX; bt.dY = dY;
 
     // Border trace
-    edgeInQueue(bt);
-    while(!bt.pixelQueue.empty()) {
-        checkNeighbors(bt, bt.pixelQueue.front());
-        bt.pixelQueue.pop();
-    }
-    fillEmptyPixels(bt);
-
-    return;
-
-    // Prevent warning
-    pixels[0] = *(uint32_t*)data;
+    borderTrace(bt);
 }
 
 
-void Julia::calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
-    return;
-
-    // Prevent error
-    mpf_t a;mpf_init(a);mpf_add(a, domain.rMax, domain.rMin);mpf_clear(a); int i = res.w; i = r.xMin; int* j = ((int*)&data); pixels[0] = i; pixels[0] = *j;
+// Not implemented for Julia sets
+void Julia::calcScreenGMP(const HighPrecDomain&, const Resolution&, const Range&, const RenderOptions&, uint32_t*) const {
 }
 
 
-void Julia::calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
+void Julia::calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
     const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
 
     double z[2];
@@ -191,34 +119,28 @@ void Julia::calcScreenBruteforce(const Domain& domain, const Resolution& res, co
         z[1] = domain.iMax - (y * pixelSize);
 
         for(unsigned int x = r.xMin; x < r.xMax; x++) {
+            // Every pixel, as a row is slow with a high nMax without a vector kernel
+            if(isCancelled(options.cancel))
+                return;
+
             z[0] = domain.rMin + (x * pixelSize);
-            pixels[y * res.w + x] = calcPixel(z, data);
+            pixels[y * res.w + x] = calcPixel(z, pixelSize, options);
         }
     }
-
-    // return pixels;
-    return;
-
-    z[0] = *(uint32_t*)data;
 }
 
 
 void Julia::calcOrbit(const double z0[2], Orbit& points) const {
-    points.push_back({z0[0], z0[1]});
-    double zSquared[2] = {z0[0] * z0[0], z0[1] * z0[1]};
+    const JuliaFormula f(c[0], c[1]);
+    double z[2], cStep[2], dz[2], zSquared[2];
+    f.start(z0, z, cStep, dz);
+    zSquared[0] = z[0] * z[0];
+    zSquared[1] = z[1] * z[1];
+    points.push_back({z[0], z[1]});
 
-    double z[2] = {z0[0], z0[1]};
     unsigned int n = 0;
     for(; n < nMax && zSquared[0] + zSquared[1] <= 4.0; n++) {
-        z[1] = z[0] * z[1] * 2.0;
-        z[0] = zSquared[0] - zSquared[1];
-
-        z[0] += c[0];
-        z[1] += c[1];
-
-        zSquared[0] = z[0] * z[0];
-        zSquared[1] = z[1] * z[1];
-
+        f.step(z, zSquared, cStep);
         points.push_back({z[0], z[1]});
     }
 }
@@ -3,6 +3,7 @@
 #define JULIA_H
 
 
+#include "formulas.h"
 #include "fractal.h"
 #include "types.h"
 
@@ -21,17 +22,17 @@ class Julia : public Fractal {
 
         // void deepenRender(uint32_t* pixels, const Domain& domain, const Resolution& res) const;
 
-        inline uint32_t colorDistance(const double d) const;
-        inline uint32_t calcDistance(const double z0[2]) const;
-        void calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
+        inline double calcDistance(const double z0[2]) const;
+        void calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
 
-        uint32_t calcPixel(const double z0[2], void* data) const;
+        // With periodicity checking
+        uint32_t calcPixel(const double z0[2], const double pixelSize, const RenderOptions& options) const;
 
-        void calcScreen(const Domain& domain, const Resolution& res, const Range& r, const double _c[2], void* data, uint32_t* pixels);
-        void calcScreen(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
-        void calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
+        void calcScreen(const Domain& domain, const Resolution& res, const Range& r, const double _c[2], const RenderOptions& options, uint32_t* pixels);
+        void calcScreen(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels, uint8_t* calculated = nullptr) const;
+        void calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
 
-        void calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, void* data, uint32_t* pixels) const;
+        void calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& range, const RenderOptions& options, uint32_t* pixels) const;
 
         void calcOrbit(const double z0[2], Orbit& points) const;
 
@@ -0,0 +1,452 @@
+
+#include "kernels.h"
+#include "formulas.h"
+#include "types.h"
+
+#include <cstdint>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+
+// The scalar kernels are the loops of Mandelbrot::calcPixel and calcDistance (formulas.h), for a batch
+static unsigned int escapeTimeScalar(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, const double epsilon, iter_t* n) {
+    const MandelbrotFormula f{};
+    unsigned int periodic = 0;
+    for(unsigned int i = 0; i < count; i++) {
+        const double c[2] = {cr[i], ci[i]};
+        bool isPeriodic;
+        n[i] = Kernel<MandelbrotFormula, double, EscapeTime>::calc(f, c, nMax, epsilon, isPeriodic);
+        periodic += isPeriodic;
+    }
+
+    return periodic;
+}
+
+static void distanceScalar(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, double* d) {
+    const MandelbrotFormula f{};
+    for(unsigned int i = 0; i < count; i++) {
+        const double c[2] = {cr[i], ci[i]};
+        d[i] = Kernel<MandelbrotFormula, double, Distance>::calc(f, c, nMax);
+    }
+}
+
+
+#ifdef KERNELS_X86
+
+// The vector kernels iterate all lanes in lockstep and keep a mask of lanes which have not escaped yet
+// An escaped lane keeps iterating (to inf/NaN), but its counter is frozen by the mask
+// The distance kernels also freeze z and dz of escaped lanes, because the estimate needs their values at escape
+// Periodic lanes get nMax and are masked out like escaped ones, all lanes save z at the same iterations
+// No FMA is used, so rounding and thus the iteration counts are identical to the scalar loop
+// AVX-512 implies FMA, so contraction is turned off for those kernels
+
+__attribute__((target("sse2")))
+static unsigned int escapeTimeSSE2(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, const double epsilon, iter_t* n) {
+    const __m128d two = _mm_set1_pd(2.0),
+                  four = _mm_set1_pd(4.0),
+                  eps = _mm_set1_pd(epsilon),
+                  sign = _mm_set1_pd(-0.0);
+    const __m128i nMaxs = _mm_set1_epi64x(nMax);
+
+    unsigned int periodic = 0;
+    for(unsigned int i = 0; i < count; i += 2) {
+        // With an odd count, the last lane repeats the previous point and starts inactive
+        const bool full = i + 1 < count;
+        const __m128d c[2] = {_mm_set_pd(cr[full ? i + 1 : i], cr[i]), _mm_set_pd(ci[full ? i + 1 : i], ci[i])};
+
+        __m128d z[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+        __m128d zSquared[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+        __m128d saved[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+        __m128d active = _mm_castsi128_pd(_mm_set_epi64x(full ? -1 : 0, -1));
+        __m128i k = _mm_setzero_si128();
+
+        for(iter_t it = 0; it < nMax; it++) {
+            active = _mm_and_pd(active, _mm_cmple_pd(_mm_add_pd(zSquared[0], zSquared[1]), four));
+            if(_mm_movemask_pd(active) == 0)
+                break;
+
+            // Active lanes are all ones (-1), so subtracting increments their counter
+            k = _mm_sub_epi64(k, _mm_castpd_si128(active));
+
+            z[1] = _mm_mul_pd(_mm_mul_pd(z[0], z[1]), two);
+            z[0] = _mm_sub_pd(zSquared[0], zSquared[1]);
+
+            z[0] = _mm_add_pd(z[0], c[0]);
+            z[1] = _mm_add_pd(z[1], c[1]);
+
+            zSquared[0] = _mm_mul_pd(z[0], z[0]);
+            zSquared[1] = _mm_mul_pd(z[1], z[1]);
+
+            // |z - saved| < epsilon in both parts; the absolute value clears the sign bit
+            const __m128d close = _mm_and_pd(_mm_cmplt_pd(_mm_andnot_pd(sign, _mm_sub_pd(z[0], saved[0])), eps),
+                                             _mm_cmplt_pd(_mm_andnot_pd(sign, _mm_sub_pd(z[1], saved[1])), eps));
+            const __m128d found = _mm_and_pd(active, close);
+            if(_mm_movemask_pd(found) != 0) {
+                k = _mm_or_si128(_mm_and_si128(_mm_castpd_si128(found), nMaxs), _mm_andnot_si128(_mm_castpd_si128(found), k));
+                active = _mm_andnot_pd(found, active);
+                periodic += __builtin_popcount(_mm_movemask_pd(found));
+            }
+            if((it & (it + 1)) == 0) {
+                saved[0] = z[0];
+                saved[1] = z[1];
+            }
+        }
+
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128((__m128i*)lanes, k);
+        n[i] = lanes[0];
+        if(full)
+            n[i + 1] = lanes[1];
+    }
+
+    return periodic;
+}
+
+__attribute__((target("sse2")))
+static void distanceSSE2(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, double* d) {
+    const __m128d one = _mm_set1_pd(1.0),
+                  two = _mm_set1_pd(2.0),
+                  four = _mm_set1_pd(4.0);
+
+    for(unsigned int i = 0; i < count; i += 2) {
+        const bool full = i + 1 < count;
+        const __m128d c[2] = {_mm_set_pd(cr[full ? i + 1 : i], cr[i]), _mm_set_pd(ci[full ? i + 1 : i], ci[i])};
+
+        __m128d z[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+        __m128d zSquared[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+        __m128d dz[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+        __m128d active = _mm_castsi128_pd(_mm_set_epi64x(full ? -1 : 0, -1));
+        __m128i k = _mm_setzero_si128();
+
+        for(iter_t it = 0; it < nMax; it++) {
+            active = _mm_and_pd(active, _mm_cmple_pd(_mm_add_pd(zSquared[0], zSquared[1]), four));
+            if(_mm_movemask_pd(active) == 0)
+                break;
+
+            k = _mm_sub_epi64(k, _mm_castpd_si128(active));
+
+            const __m128d dzNew[2] = {_mm_add_pd(_mm_mul_pd(two, _mm_sub_pd(_mm_mul_pd(z[0], dz[0]), _mm_mul_pd(z[1], dz[1]))), one),
+                                      _mm_mul_pd(two, _mm_add_pd(_mm_mul_pd(z[0], dz[1]), _mm_mul_pd(z[1], dz[0])))};
+            const __m128d zNew[2] = {_mm_add_pd(_mm_sub_pd(zSquared[0], zSquared[1]), c[0]),
+                                     _mm_add_pd(_mm_mul_pd(_mm_mul_pd(z[0], z[1]), two), c[1])};
+
+            // Only update the lanes which have not escaped (SSE2 has no blend)
+            for(int j = 0; j < 2; j++) {
+                dz[j] = _mm_or_pd(_mm_and_pd(active, dzNew[j]), _mm_andnot_pd(active, dz[j]));
+                z[j] = _mm_or_pd(_mm_and_pd(active, zNew[j]), _mm_andnot_pd(active, z[j]));
+            }
+
+            zSquared[0] = _mm_mul_pd(z[0], z[0]);
+            zSquared[1] = _mm_mul_pd(z[1], z[1]);
+        }
+
+        alignas(16) int64_t lanes[2];
+        alignas(16) double zr[2], zi[2], dzr[2], dzi[2];
+        _mm_store_si128((__m128i*)lanes, k);
+        _mm_store_pd(zr, z[0]); _mm_store_pd(zi, z[1]); _mm_store_pd(dzr, dz[0]); _mm_store_pd(dzi, dz[1]);
+        for(unsigned int l = 0; l < 2 && i + l < count; l++) {
+            const double zl[2] = {zr[l], zi[l]}, dzl[2] = {dzr[l], dzi[l]};
+            d[i + l] = ((iter_t)lanes[l] == nMax ? 0.0 : estimateDistance(zl, dzl));
+        }
+    }
+}
+
+
+__attribute__((target("avx2")))
+static unsigned int escapeTimeAVX2(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, const double epsilon, iter_t* n) {
+    const __m256d two = _mm256_set1_pd(2.0),
+                  four = _mm256_set1_pd(4.0),
+                  eps = _mm256_set1_pd(epsilon),
+                  sign = _mm256_set1_pd(-0.0);
+    const __m256i laneIndex = _mm256_set_epi64x(3, 2, 1, 0),
+                  nMaxs = _mm256_set1_epi64x(nMax);
+
+    unsigned int periodic = 0;
+    for(unsigned int i = 0; i < count; i += 4) {
+        // Lanes past count are masked out of the load and start inactive
+        const __m256i load = _mm256_cmpgt_epi64(_mm256_set1_epi64x(count - i), laneIndex);
+        const __m256d c[2] = {_mm256_maskload_pd(cr + i, load), _mm256_maskload_pd(ci + i, load)};
+
+        __m256d z[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+        __m256d zSquared[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+        __m256d saved[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+        __m256d active = _mm256_castsi256_pd(load);
+        __m256i k = _mm256_setzero_si256();
+
+        for(iter_t it = 0; it < nMax; it++) {
+            active = _mm256_and_pd(active, _mm256_cmp_pd(_mm256_add_pd(zSquared[0], zSquared[1]), four, _CMP_LE_OQ));
+            if(_mm256_movemask_pd(active) == 0)
+                break;
+
+            // Active lanes are all ones (-1), so subtracting increments their counter
+            k = _mm256_sub_epi64(k, _mm256_castpd_si256(active));
+
+            z[1] = _mm256_mul_pd(_mm256_mul_pd(z[0], z[1]), two);
+            z[0] = _mm256_sub_pd(zSquared[0], zSquared[1]);
+
+            z[0] = _mm256_add_pd(z[0], c[0]);
+            z[1] = _mm256_add_pd(z[1], c[1]);
+
+            zSquared[0] = _mm256_mul_pd(z[0], z[0]);
+            zSquared[1] = _mm256_mul_pd(z[1], z[1]);
+
+            // |z - saved| < epsilon in both parts; the absolute value clears the sign bit
+            const __m256d close = _mm256_and_pd(_mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(z[0], saved[0])), eps, _CMP_LT_OQ),
+                                                _mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(z[1], saved[1])), eps, _CMP_LT_OQ));
+            const __m256d found = _mm256_and_pd(active, close);
+            if(_mm256_movemask_pd(found) != 0) {
+                k = _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(k), _mm256_castsi256_pd(nMaxs), found));
+                active = _mm256_andnot_pd(found, active);
+                periodic += __builtin_popcount(_mm256_movemask_pd(found));
+            }
+            if((it & (it + 1)) == 0) {
+                saved[0] = z[0];
+                saved[1] = z[1];
+            }
+        }
+
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256((__m256i*)lanes, k);
+        for(unsigned int l = 0; l < 4 && i + l < count; l++)
+            n[i + l] = lanes[l];
+    }
+
+    return periodic;
+}
+
+__attribute__((target("avx2")))
+static void distanceAVX2(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, double* d) {
+    const __m256d one = _mm256_set1_pd(1.0),
+                  two = _mm256_set1_pd(2.0),
+                  four = _mm256_set1_pd(4.0);
+    const __m256i laneIndex = _mm256_set_epi64x(3, 2, 1, 0);
+
+    for(unsigned int i = 0; i < count; i += 4) {
+        const __m256i load = _mm256_cmpgt_epi64(_mm256_set1_epi64x(count - i), laneIndex);
+        const __m256d c[2] = {_mm256_maskload_pd(cr + i, load), _mm256_maskload_pd(ci + i, load)};
+
+        __m256d z[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+        __m256d zSquared[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+        __m256d dz[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+        __m256d active = _mm256_castsi256_pd(load);
+        __m256i k = _mm256_setzero_si256();
+
+        for(iter_t it = 0; it < nMax; it++) {
+            active = _mm256_and_pd(active, _mm256_cmp_pd(_mm256_add_pd(zSquared[0], zSquared[1]), four, _CMP_LE_OQ));
+            if(_mm256_movemask_pd(active) == 0)
+                break;
+
+            k = _mm256_sub_epi64(k, _mm256_castpd_si256(active));
+
+            const __m256d dzNew[2] = {_mm256_add_pd(_mm256_mul_pd(two, _mm256_sub_pd(_mm256_mul_pd(z[0], dz[0]), _mm256_mul_pd(z[1], dz[1]))), one),
+                                      _mm256_mul_pd(two, _mm256_add_pd(_mm256_mul_pd(z[0], dz[1]), _mm256_mul_pd(z[1], dz[0])))};
+            const __m256d zNew[2] = {_mm256_add_pd(_mm256_sub_pd(zSquared[0], zSquared[1]), c[0]),
+                                     _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(z[0], z[1]), two), c[1])};
+
+            // Only update the lanes which have not escaped
+            for(int j = 0; j < 2; j++) {
+                dz[j] = _mm256_blendv_pd(dz[j], dzNew[j], active);
+                z[j] = _mm256_blendv_pd(z[j], zNew[j], active);
+            }
+
+            zSquared[0] = _mm256_mul_pd(z[0], z[0]);
+            zSquared[1] = _mm256_mul_pd(z[1], z[1]);
+        }
+
+        alignas(32) int64_t lanes[4];
+        alignas(32) double zr[4], zi[4], dzr[4], dzi[4];
+        _mm256_store_si256((__m256i*)lanes, k);
+        _mm256_store_pd(zr, z[0]); _mm256_store_pd(zi, z[1]); _mm256_store_pd(dzr, dz[0]); _mm256_store_pd(dzi, dz[1]);
+        for(unsigned int l = 0; l < 4 && i + l < count; l++) {
+            const double zl[2] = {zr[l], zi[l]}, dzl[2] = {dzr[l], dzi[l]};
+            d[i + l] = ((iter_t)lanes[l] == nMax ? 0.0 : estimateDistance(zl, dzl));
+        }
+    }
+}
+
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static unsigned int escapeTimeAVX512(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, const double epsilon, iter_t* n) {
+    const __m512d two = _mm512_set1_pd(2.0),
+                  four = _mm512_set1_pd(4.0),
+                  eps = _mm512_set1_pd(epsilon);
+    const __m512i one = _mm512_set1_epi64(1),
+                  nMaxs = _mm512_set1_epi64(nMax);
+
+    unsigned int periodic = 0;
+    for(unsigned int i = 0; i < count; i += 8) {
+        // Lanes past count are masked out of the load and start inactive
+        const __mmask8 load = count - i >= 8 ? 0xFF : (__mmask8)((1 << (count - i)) - 1);
+        const __m512d c[2] = {_mm512_maskz_loadu_pd(load, cr + i), _mm512_maskz_loadu_pd(load, ci + i)};
+
+        __m512d z[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+        __m512d zSquared[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+        __m512d saved[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+        __mmask8 active = load;
+        __m512i k = _mm512_setzero_si512();
+
+        for(iter_t it = 0; it < nMax; it++) {
+            active = _mm512_mask_cmp_pd_mask(active, _mm512_add_pd(zSquared[0], zSquared[1]), four, _CMP_LE_OQ);
+            if(active == 0)
+                break;
+
+            k = _mm512_mask_add_epi64(k, active, k, one);
+
+            z[1] = _mm512_mul_pd(_mm512_mul_pd(z[0], z[1]), two);
+            z[0] = _mm512_sub_pd(zSquared[0], zSquared[1]);
+
+            z[0] = _mm512_add_pd(z[0], c[0]);
+            z[1] = _mm512_add_pd(z[1], c[1]);
+
+            zSquared[0] = _mm512_mul_pd(z[0], z[0]);
+            zSquared[1] = _mm512_mul_pd(z[1], z[1]);
+
+            __mmask8 found = _mm512_mask_cmp_pd_mask(active, _mm512_abs_pd(_mm512_sub_pd(z[0], saved[0])), eps, _CMP_LT_OQ);
+            found = _mm512_mask_cmp_pd_mask(found, _mm512_abs_pd(_mm512_sub_pd(z[1], saved[1])), eps, _CMP_LT_OQ);
+            if(found != 0) {
+                k = _mm512_mask_mov_epi64(k, found, nMaxs);
+                active &= ~found;
+                periodic += __builtin_popcount(found);
+            }
+            if((it & (it + 1)) == 0) {
+                saved[0] = z[0];
+                saved[1] = z[1];
+            }
+        }
+
+        alignas(64) int64_t lanes[8];
+        _mm512_store_si512((void*)lanes, k);
+        for(unsigned int l = 0; l < 8 && i + l < count; l++)
+            n[i + l] = lanes[l];
+    }
+
+    return periodic;
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static void distanceAVX512(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, double* d) {
+    const __m512d one = _mm512_set1_pd(1.0),
+                  two = _mm512_set1_pd(2.0),
+                  four = _mm512_set1_pd(4.0);
+    const __m512i oneIter = _mm512_set1_epi64(1);
+
+    for(unsigned int i = 0; i < count; i += 8) {
+        const __mmask8 load = count - i >= 8 ? 0xFF : (__mmask8)((1 << (count - i)) - 1);
+        const __m512d c[2] = {_mm512_maskz_loadu_pd(load, cr + i), _mm512_maskz_loadu_pd(load, ci + i)};
+
+        __m512d z[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+        __m512d zSquared[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+        __m512d dz[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+        __mmask8 active = load;
+        __m512i k = _mm512_setzero_si512();
+
+        for(iter_t it = 0; it < nMax; it++) {
+            active = _mm512_mask_cmp_pd_mask(active, _mm512_add_pd(zSquared[0], zSquared[1]), four, _CMP_LE_OQ);
+            if(active == 0)
+                break;
+
+            k = _mm512_mask_add_epi64(k, active, k, oneIter);
+
+            // Only update the lanes which have not escaped
+            const __m512d dzNew = _mm512_add_pd(_mm512_mul_pd(two, _mm512_sub_pd(_mm512_mul_pd(z[0], dz[0]), _mm512_mul_pd(z[1], dz[1]))), one);
+            dz[1] = _mm512_mask_mul_pd(dz[1], active, two, _mm512_add_pd(_mm512_mul_pd(z[0], dz[1]), _mm512_mul_pd(z[1], dz[0])));
+            dz[0] = _mm512_mask_mov_pd(dz[0], active, dzNew);
+
+            const __m512d zNew = _mm512_add_pd(_mm512_sub_pd(zSquared[0], zSquared[1]), c[0]);
+            z[1] = _mm512_mask_add_pd(z[1], active, _mm512_mul_pd(_mm512_mul_pd(z[0], z[1]), two), c[1]);
+            z[0] = _mm512_mask_mov_pd(z[0], active, zNew);
+
+            zSquared[0] = _mm512_mul_pd(z[0], z[0]);
+            zSquared[1] = _mm512_mul_pd(z[1], z[1]);
+        }
+
+        alignas(64) int64_t lanes[8];
+        alignas(64) double zr[8], zi[8], dzr[8], dzi[8];
+        _mm512_store_si512((void*)lanes, k);
+        _mm512_store_pd(zr, z[0]); _mm512_store_pd(zi, z[1]); _mm512_store_pd(dzr, dz[0]); _mm512_store_pd(dzi, dz[1]);
+        for(unsigned int l = 0; l < 8 && i + l < count; l++) {
+            const double zl[2] = {zr[l], zi[l]}, dzl[2] = {dzr[l], dzi[l]};
+            d[i + l] = ((iter_t)lanes[l] == nMax ? 0.0 : estimateDistance(zl, dzl));
+        }
+    }
+}
+
+
+// Value of extended control register 0, which tells which register states the OS saves on a context switch
+static uint64_t xgetbv() {
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+#endif  // KERNELS_X86
+
+
+static KernelISA detectISA() {
+#ifdef KERNELS_X86
+    unsigned int eax, ebx, ecx, edx;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return KernelISA::Scalar;
+
+    const bool sse2 = edx & bit_SSE2;
+
+    // AVX registers may only be used if the OS saves them (xmm and ymm state, plus opmask and zmm state for AVX-512)
+    const uint64_t xcr0 = ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) ? xgetbv() : 0;
+    const bool ymmSaved = (xcr0 & 0x06) == 0x06,
+               zmmSaved = (xcr0 & 0xE6) == 0xE6;
+
+    bool avx2 = false, avx512 = false;
+    if(__get_cpuid_max(0, nullptr) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        avx2 = ebx & bit_AVX2;
+        avx512 = ebx & bit_AVX512F;
+    }
+
+    if(avx512 && zmmSaved)
+        return KernelISA::AVX512;
+    if(avx2 && ymmSaved)
+        return KernelISA::AVX2;
+    if(sse2)
+        return KernelISA::SSE2;
+#endif
+
+    return KernelISA::Scalar;
+}
+
+static KernelISA supportedISA() {
+    static const KernelISA isa = detectISA();
+    return isa;
+}
+
+
+// Ordered from narrowest to widest
+static const KernelSet kernelSets[] = {
+    {KernelISA::Scalar, "scalar", escapeTimeScalar, distanceScalar},
+#ifdef KERNELS_X86
+    {KernelISA::SSE2, "SSE2", escapeTimeSSE2, distanceSSE2},
+    {KernelISA::AVX2, "AVX2", escapeTimeAVX2, distanceAVX2},
+    {KernelISA::AVX512, "AVX-512", escapeTimeAVX512, distanceAVX512},
+#endif
+};
+
+
+const KernelSet& kernels() {
+    static const KernelSet* const best = kernels(supportedISA());
+    return *best;
+}
+
+const KernelSet* kernels(const KernelISA isa) {
+    if(isa > supportedISA())
+        return nullptr;
+
+    for(auto& k : kernelSets)
+        if(k.isa == isa)
+            return &k;
+
+    return nullptr;
+}
@@ -0,0 +1,49 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+
+#include "types.h"
+
+
+// Number of points a kernel call is given at most by the fractal classes
+// Multiple of the widest vector (8 doubles), so only the last batch of a row has inactive lanes
+const unsigned int BATCHSIZE = 64;
+
+
+// Escape time kernels for the Mandelbrot set
+// Iterates count points c = (cr[i], ci[i]) and writes the number of iterations before escaping to n[i]
+// A point whose orbit comes back within epsilon (in both parts) of the point saved at the last power of two iterations is periodic (Brent),
+// so it's in the set and gets nMax right away; epsilon 0 turns this off. Returns the number of periodic points
+// All variants produce the same iteration counts as Mandelbrot::calcPixel
+typedef unsigned int (*EscapeTimeKernel)(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, const double epsilon, iter_t* n);
+
+// Exterior distance estimation kernels for the Mandelbrot set
+// Writes the estimated distance to the set to d[i], or 0 if the point did not escape
+typedef void (*DistanceKernel)(const double* cr, const double* ci, const unsigned int count, const iter_t nMax, double* d);
+
+
+// Every kernel is compiled once per instruction set
+enum class KernelISA {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+struct KernelSet {
+    KernelISA isa;
+    const char* name;
+
+    EscapeTimeKernel escapeTime;
+    DistanceKernel distance;
+};
+
+
+// Kernels for the widest instruction set supported by the CPU and OS (detected with cpuid on first call)
+const KernelSet& kernels();
+
+// Kernels for a specific instruction set; nullptr if not supported by this CPU
+const KernelSet* kernels(const KernelISA isa);
+
+
+#endif  // KERNELS_H
@@ -1,22 +1,22 @@
 
 #include "mandelbrot.h"
 #include "mandelbrotGMP.cpp"
+#include "mandelbrotPerturbation.cpp"
 
 #include "types.h"
 
 #include <cstring>
 #include <cstdint>
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 
 // TODO: Put most efficient calcScreen function here. This allows us to easily change calcScreen to a more efficient one without changing any other code
 // const auto calcScreen = newIdFromDatabase;
 
 
-static double LINEWIDTH;
-
-
-Mandelbrot::Mandelbrot() : Fractal(Fractals::Mandelbrot, -2.0, 1.0, 0.0) {
+Mandelbrot::Mandelbrot() : Fractal(Fractals::Mandelbrot, -2.0, 1.0, 0.0), escapeTime(kernels().escapeTime), distance(kernels().distance) {
 
 }
 
@@ -42,101 +42,132 @@ Mandelbrot::~Mandelbrot() {
 // }
 
 
-inline uint32_t Mandelbrot::colorDistance(const double d) const {
-    if(d < LINEWIDTH)
-        return 0x0;
-    else
-        return 0xFFFFFF00;
-}
-
-// Exterior distance estimation
-inline uint32_t Mandelbrot::calcDistance(const double c[2], const ShapeVector& shapes) const {
+// Exterior distance estimation; 0 for points in the set
+inline double Mandelbrot::calcDistance(const double c[2], const ShapeSet shapes) const {
     // Check shapes
-    for(auto& inShape : shapes)
-        if(inShape(c))
-            return 0x0;
-
-    double z[2] = {0, 0}, zSquared[2] = {0, 0};
-    double dzNew, dz[2] = {0, 0};
+    if(inShapes(shapes, c))
+        return 0.0;
 
-    iter_t n = 0;
-    for(; n < nMax && zSquared[0] + zSquared[1] <= 4.0; n++) {
-        //dz = (2.0 * z * dz) + 1.0;
-        // TODO dzNew = fma(2.0, ((z[0] * dz[0]) - (z[1] * dz[1])), 1.0);  // fma(a, b, c) -> a * b + c
-        dzNew = 2.0 * ((z[0] * dz[0]) - (z[1] * dz[1])) + 1.0;
-        dz[1] = 2.0 * ((z[0] * dz[1]) + (z[1] * dz[0]));
-        dz[0] = dzNew;
+    return Kernel<MandelbrotFormula, double, Distance>::calc(MandelbrotFormula(), c, nMax);
+}
 
-        // z = z^2 + c
-        z[1] = z[0] * z[1] * 2.0;
-        z[0] = zSquared[0] - zSquared[1];
-        z[0] += c[0];
-        z[1] += c[1];
+// Points in a shape are colored directly, the others are packed together and given to the vector kernel
+void Mandelbrot::calcDistances(const double* cr, const double* ci, const unsigned int count, const ShapeSet shapes, const double width, uint32_t* colors) const {
+    double packedr[BATCHSIZE], packedi[BATCHSIZE], d[BATCHSIZE];
+    unsigned int index[BATCHSIZE];
+    for(unsigned int b = 0; b < count; b += BATCHSIZE) {
+        const unsigned int end = std::min(b + BATCHSIZE, count);
+
+        unsigned int packed = 0;
+        for(unsigned int i = b; i < end; i++) {
+            const double c[2] = {cr[i], ci[i]};
+            if(inShapes(shapes, c)) {
+                colors[i] = 0x0;
+                continue;
+            }
+
+            packedr[packed] = cr[i];
+            packedi[packed] = ci[i];
+            index[packed] = i;
+            packed++;
+        }
 
-        zSquared[0] = z[0] * z[0];
-        zSquared[1] = z[1] * z[1];
+        distance(packedr, packedi, packed, nMax, d);
+        for(unsigned int i = 0; i < packed; i++)
+            colors[index[i]] = packDistance(d[i], width);
     }
-
-    if(n == nMax)
-        return 0x0;
-
-    // Calculate modulus
-    z[0] = sqrt(zSquared[0] + zSquared[1]);
-    dz[0] = sqrt((dz[0] * dz[0]) + (dz[1] * dz[1]));
-    return colorDistance((log(z[0] * z[0]) * z[0]) / dz[0]);
 }
 
-void Mandelbrot::calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
-    const ShapeVector shapes = (data == nullptr ? ShapeVector() : *(ShapeVector*)data);
+void Mandelbrot::calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
+    const ShapeSet shapes = cullShapes(options.shapes, domain, res, r);
     const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
 
-    LINEWIDTH = (domain.rMax - domain.rMin) / lineDetail;
+    // Calculate a row at a time with the vector kernel
+    std::vector<double> cr(r.xMax - r.xMin), ci(r.xMax - r.xMin);
+    for(unsigned int x = r.xMin; x < r.xMax; x++)
+        cr[x - r.xMin] = domain.rMin + (x * pixelSize);
 
-    // Normal calculation
-    double c[2];
     for(unsigned int y = r.yMin; y < r.yMax; y++) {
-        c[1] = domain.iMax - (y * pixelSize);
-        
-        for(unsigned int x = r.xMin; x < r.xMax; x++) {
-            c[0] = domain.rMin + (x * pixelSize);
+        if(isCancelled(options.cancel))
+            return;
 
-            pixels[y * res.w + x] = calcDistance(c, shapes);
-        }
+        std::fill(ci.begin(), ci.end(), domain.iMax - (y * pixelSize));
+        calcDistances(cr.data(), ci.data(), r.xMax - r.xMin, shapes, domain.rMax - domain.rMin, pixels + (y * res.w) + r.xMin);
     }
 }
 
 
-// With caching and shape checking
-uint32_t Mandelbrot::calcPixel(const double c[2], void* data) const {
+// With caching, shape and periodicity checking
+uint32_t Mandelbrot::calcPixel(const double c[2], const double pixelSize, const RenderOptions& options) const {
     // Check shapes
-    ShapeVector shapes = *(ShapeVector*)data;
-    for(auto& inShape : shapes)
-        if(inShape(c))
-            return 0x0;
+    if(inShapes(options.shapes, c))
+        return 0x0;
 
-    double z[2] = {0, 0};
-    double zSquared[2] = {0, 0};  // caches squares of real and imaginary part
+    bool periodic;
+    const iter_t n = Kernel<MandelbrotFormula, double, EscapeTime>::calc(MandelbrotFormula(), c, nMax, periodicity * pixelSize, periodic);
+    if(periodic)
+        periodicCount.add(1);
 
-    // Escape iteration loop
-    iter_t n = 0;
-    for(; n < nMax && zSquared[0] + zSquared[1] <= 4.0; n++) {
-        z[1] = z[0] * z[1] * 2.0;
-        z[0] = zSquared[0] - zSquared[1];
+    return packIterations(n, nMax);
+}
 
-        z[0] += c[0];
-        z[1] += c[1];
+// Points in a shape are colored directly, the others are packed together and given to the vector kernel
+void Mandelbrot::calcPixels(const double* cr, const double* ci, const unsigned int count, const double pixelSize, const RenderOptions& options, uint32_t* colors) const {
+    const ShapeSet shapes = options.shapes;
+    const double epsilon = periodicity * pixelSize;
+    unsigned int periodic = 0;
+
+    double packedr[BATCHSIZE], packedi[BATCHSIZE];
+    unsigned int index[BATCHSIZE];
+    iter_t n[BATCHSIZE];
+    for(unsigned int b = 0; b < count; b += BATCHSIZE) {
+        const unsigned int end = std::min(b + BATCHSIZE, count);
+
+        unsigned int packed = 0;
+        for(unsigned int i = b; i < end; i++) {
+            const double c[2] = {cr[i], ci[i]};
+            if(inShapes(shapes, c)) {
+                colors[i] = 0x0;
+                continue;
+            }
+
+            packedr[packed] = cr[i];
+            packedi[packed] = ci[i];
+            index[packed] = i;
+            packed++;
+        }
 
-        zSquared[0] = z[0] * z[0];
-        zSquared[1] = z[1] * z[1];
+        periodic += escapeTime(packedr, packedi, packed, nMax, epsilon, n);
+        for(unsigned int i = 0; i < packed; i++)
+            colors[index[i]] = packIterations(n[i], nMax);
     }
 
-    return calcColor(n);
+    if(periodic > 0)
+        periodicCount.add(periodic);
+}
+
+
+// Same as calcPixel in double-double precision
+// Shapes are checked with the high parts, which is only off for points within about 1e-16 of a shape's edge
+// The periodicity check only needs the high parts of the difference, as epsilon is far above the precision of double-doubles
+uint32_t Mandelbrot::calcPixel(const DoubleDouble c[2], const DoubleDouble& pixelSize, const RenderOptions& options) const {
+    const double cHi[2] = {c[0].hi, c[1].hi};
+    if(inShapes(options.shapes, cHi))
+        return 0x0;
+
+    bool periodic;
+    const iter_t n = Kernel<MandelbrotFormula, DoubleDouble, EscapeTime>::calc(MandelbrotFormula(), c, nMax, periodicity * pixelSize.hi, periodic);
+    if(periodic)
+        periodicCount.add(1);
+
+    return packIterations(n, nMax);
 }
 
 
 // With border trace + shape checking
-void Mandelbrot::calcScreen(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
-    const ShapeVector s = (data == nullptr ? ShapeVector() : *(ShapeVector*)data);
+void Mandelbrot::calcScreen(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels, uint8_t* calculated) const {
+    RenderOptions tile = options;
+    tile.shapes = cullShapes(options.shapes, domain, res, r);  // Only the shapes in this tile
 
     const double ps = (domain.rMax - domain.rMin) / (double)res.w;  // Pixel size
     const unsigned int dX = r.xMax - r.xMin,
@@ -144,23 +175,39 @@ void Mandelbrot::calcScreen(const Domain& domain, const Resolution& res, const R
 
     // Set border trace struct up
     BorderTrace bt;
-    bt.pixels = pixels; bt.pixelSize = ps; bt.data = (void*)&s;
+    bt.pixels = pixels; bt.pixelSize = ps; bt.options = &tile; bt.calculated = calculated;
     bt.rMin = domain.rMin; bt.iMax = domain.iMax;
     bt.w = res.w; bt.h = res.h;
     bt.xMin = r.xMin; bt.xMax = r.xMax; bt.yMin = r.yMin; bt.yMax = r.yMax; bt.dX = dX; bt.dY = dY;
 
     // Border trace
-    edgeInQueue(bt);
-    while(!bt.pixelQueue.empty()) {
-        checkNeighbors(bt, bt.pixelQueue.front());
-        bt.pixelQueue.pop();
-    }
-    fillEmptyPixels(bt);
+    borderTrace(bt);
 }
 
 
-void Mandelbrot::calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
-    const ShapeVector shapes = (data == nullptr ? ShapeVector() : *(ShapeVector*)data);
+// Calculates a row at a time with the vector kernel
+void Mandelbrot::calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
+    RenderOptions tile = options;
+    tile.shapes = cullShapes(options.shapes, domain, res, r);
+    const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
+
+    std::vector<double> cr(r.xMax - r.xMin), ci(r.xMax - r.xMin);
+    for(unsigned int x = r.xMin; x < r.xMax; x++)
+        cr[x - r.xMin] = domain.rMin + (x * pixelSize);
+
+    for(unsigned int y = r.yMin; y < r.yMax; y++) {
+        if(isCancelled(options.cancel))
+            return;
+
+        std::fill(ci.begin(), ci.end(), domain.iMax - (y * pixelSize));
+        calcPixels(cr.data(), ci.data(), r.xMax - r.xMin, pixelSize, tile, pixels + (y * res.w) + r.xMin);
+    }
+}
+
+// Calculates every pixel with calcPixel
+void Mandelbrot::calcScreenBruteforceScalar(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
+    RenderOptions tile = options;
+    tile.shapes = cullShapes(options.shapes, domain, res, r);
     const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
 
     double c[2];
@@ -170,7 +217,7 @@ void Mandelbrot::calcScreenBruteforce(const Domain& domain, const Resolution& re
         for(unsigned int x = r.xMin; x < r.xMax; x++) {
             c[0] = domain.rMin + (x * pixelSize);
 
-            pixels[y * res.w + x] = calcPixel(c, (void*)&shapes);
+            pixels[y * res.w + x] = calcPixel(c, pixelSize, tile);
         }
     }
 }
@@ -193,10 +240,10 @@ inline uint32_t Mandelbrot::calcPixelNoShape(const double c[2]) const {
         zSquared[1] = z[1] * z[1];
     }
 
-    return calcColor(n);
+    return packIterations(n, nMax);
 }
 
-void Mandelbrot::calcScreenBruteforceNoShape(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
+void Mandelbrot::calcScreenBruteforceNoShape(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions&, uint32_t* pixels) const {
     const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
 
     double c[2];
@@ -209,16 +256,11 @@ void Mandelbrot::calcScreenBruteforceNoShape(const Domain& domain, const Resolut
             pixels[y * res.w + x] = calcPixelNoShape(c);
         }
     }
-
-    return;
-
-    // Prevent error
-    data = (double*)&data;
 }
 
 
-uint32_t Mandelbrot::calcPixelShapeWrong(const double c[2], void* data) const {
-    const ShapeVector shapes = (data == nullptr ? ShapeVector() : *(ShapeVector*)data);
+uint32_t Mandelbrot::calcPixelShapeWrong(const double c[2], const RenderOptions& options) const {
+    const ShapeSet shapes = options.shapes;
 
     double z[2] = {0, 0};
     double zSquared[2] = {0, 0};  // caches squares of real and imaginary part
@@ -237,16 +279,14 @@ uint32_t Mandelbrot::calcPixelShapeWrong(const double c[2], void* data) const {
         zSquared[1] = z[1] * z[1];
 
         // Check shapes
-        for(auto& inShape : shapes)
-            if(inShape(z))
-                return 0x0;
+        if(inShapes(shapes, z))
+            return 0x0;
     }
 
-    return calcColor(n);
+    return packIterations(n, nMax);
 }
 
-void Mandelbrot::calcScreenShapeWrong(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
-    const ShapeVector shapes = (data == nullptr ? ShapeVector() : *(ShapeVector*)data);
+void Mandelbrot::calcScreenShapeWrong(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
     const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
 
     double c[2];
@@ -256,29 +296,23 @@ void Mandelbrot::calcScreenShapeWrong(const Domain& domain, const Resolution& re
         for(unsigned int x = r.xMin; x < r.xMax; x++) {
             c[0] = domain.rMin + (x * pixelSize);
 
-            pixels[y * res.w + x] = calcPixelShapeWrong(c, (void*)&shapes);
+            pixels[y * res.w + x] = calcPixelShapeWrong(c, options);
         }
     }
 }
 
 
 void Mandelbrot::calcOrbit(const double c[2], Orbit& points) const {
-    points.push_back({0, 0});
-    double z[2] = {0, 0};
-    double zSquared[2] = {0, 0};  // caches squares of real and imaginary part
+    const MandelbrotFormula f{};
+    double z[2], cStep[2], dz[2], zSquared[2];
+    f.start(c, z, cStep, dz);
+    zSquared[0] = z[0] * z[0];
+    zSquared[1] = z[1] * z[1];
+    points.push_back({z[0], z[1]});
 
-    // Escape iteration loop
     iter_t n = 0;
     for(; n < nMax && zSquared[0] + zSquared[1] <= 4.0; n++) {
-        z[1] = z[0] * z[1] * 2.0;
-        z[0] = zSquared[0] - zSquared[1];
-
-        z[0] += c[0];
-        z[1] += c[1];
-
-        zSquared[0] = z[0] * z[0];
-        zSquared[1] = z[1] * z[1];
-
+        f.step(z, zSquared, cStep);
         points.push_back({z[0], z[1]});
     }
 }
@@ -3,50 +3,71 @@
 #define MANDELBROT_H
 
 
+#include "formulas.h"
 #include "fractal.h"
+#include "kernels.h"
 #include "shapes.h"
 #include "types.h"
 
 #include <cstdint>
 
 
+// Filled by calcScreenPerturbation
+struct PerturbationStats {
+    unsigned int references;  // Reference orbits calculated
+    unsigned int glitched;    // Pixels still glitched after the last reference
+    iter_t skipped;           // Iterations skipped with the series approximation of the first reference
+};
+
+
 class Mandelbrot : public Fractal {
     public:
         Mandelbrot();
         ~Mandelbrot();
 
         // Escape time coloring with bordertrace + symmetry
-        void calcScreen(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
-        // With shape checking
-        uint32_t calcPixel(const double c[2], void* data) const;
+        void calcScreen(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels, uint8_t* calculated = nullptr) const;
+        // With shape and periodicity checking
+        uint32_t calcPixel(const double c[2], const double pixelSize, const RenderOptions& options) const;
+        // Same as calcPixel for count points at once, using the vector escape time kernel
+        void calcPixels(const double* cr, const double* ci, const unsigned int count, const double pixelSize, const RenderOptions& options, uint32_t* colors) const;
+        // Same as calcPixel in double-double precision, for calcScreenDoubleDouble
+        uint32_t calcPixel(const DoubleDouble c[2], const DoubleDouble& pixelSize, const RenderOptions& options) const;
 
-        // Distance estimation coloring
-        inline uint32_t colorDistance(const double d) const;
-        inline uint32_t calcDistance(const double c[2], const ShapeVector& shapes) const;
-        void calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
+        // Distance estimation coloring; the distances are packed relative to width, the width of the domain
+        inline double calcDistance(const double c[2], const ShapeSet shapes) const;
+        void calcDistances(const double* cr, const double* ci, const unsigned int count, const ShapeSet shapes, const double width, uint32_t* colors) const;
+        void calcScreenDistance(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
 
 
         // void deepenRender(uint32_t* pixels, const Domain& domain, const Resolution& res) const;
 
-        void calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
-        void calcScreenGMPBruteforce(const HighPrecDomain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
+        void calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
+        void calcScreenGMPBruteforce(const HighPrecDomain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
         
-void calcScreenGMP(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
+void calcScreenGMP(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
 void calcScreenGMP(const Domain& domain, const Resolution& res, uint32_t* pixels) const;
 
+        // Perturbation theory: one GMP reference orbit, every pixel iterated as a double precision difference to it
+        void calcScreenPerturbation(const HighPrecDomain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
+
 
         // Different variants
-        void calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
+        void calcScreenBruteforce(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
+        void calcScreenBruteforceScalar(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
         inline uint32_t calcPixelNoShape(const double c[2]) const;
-        void calcScreenBruteforceNoShape(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
-        uint32_t calcPixelShapeWrong(const double c[2], void* data) const;
-        void calcScreenShapeWrong(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const;
+        void calcScreenBruteforceNoShape(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
+        uint32_t calcPixelShapeWrong(const double c[2], const RenderOptions& options) const;
+        void calcScreenShapeWrong(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const;
 
         void calcOrbit(const double c[2], Orbit& points) const;
 
 
 
     private: 
+        // Chosen at runtime for the CPU
+        const EscapeTimeKernel escapeTime;
+        const DistanceKernel distance;
 };
 
 
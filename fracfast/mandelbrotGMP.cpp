@@ -8,43 +8,38 @@
 
 
 // With border trace
-void Mandelbrot::calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
-    // const ShapeVector s = (data == nullptr ? ShapeVector() : *(ShapeVector*)data);
+void Mandelbrot::calcScreenGMP(const HighPrecDomain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
     const unsigned int dX = r.xMax - r.xMin,
                        dY = r.yMax - r.yMin;
 
     // Set border trace struct up
     HighPrecBorderTrace bt;
-    mpf_inits(bt.rMin, bt.iMax, bt.cr, bt.ci, bt.zr, bt.zi, bt.zSquaredr, bt.zSquaredi, bt.dist, bt.pixelSize, NULL);
+    mpf_inits(bt.rMin, bt.iMax, bt.cr, bt.ci, bt.zr, bt.zi, bt.zSquaredr, bt.zSquaredi, bt.dist, bt.savedr, bt.savedi, bt.epsilon, bt.pixelSize, NULL);
 
     // const double ps = (domain.rMax - domain.rMin) / (double)res.w;
     mpf_sub(bt.pixelSize, domain.rMax, domain.rMin);
     mpf_div_ui(bt.pixelSize, bt.pixelSize, res.w);
+
+    // epsilon = periodicity * ps
+    mpf_set_d(bt.epsilon, periodicity);
+    mpf_mul(bt.epsilon, bt.epsilon, bt.pixelSize);
     
     // bt.rMin = domain.rMin; bt.iMax = domain.iMax;
     mpf_set(bt.rMin, domain.rMin);
     mpf_set(bt.iMax, domain.iMax);
 
-    bt.pixels = pixels; bt.data = nullptr;
+    bt.pixels = pixels; bt.options = &options;
     bt.w = res.w; bt.h = res.h;
     bt.xMin = r.xMin; bt.xMax = r.xMax; bt.yMin = r.yMin; bt.yMax = r.yMax; bt.dX = dX; bt.dY = dY;
 
     // Border trace
-    edgeInQueue(bt);
-    while(!bt.pixelQueue.empty()) {
-        checkNeighbors(bt, bt.pixelQueue.front());
-        bt.pixelQueue.pop();
-    }
-    fillEmptyPixels(bt);
+    borderTrace(bt);
 
-    return;
-
-    // Prevent error
-    pixels = (uint32_t*)data;
+    mpf_clears(bt.rMin, bt.iMax, bt.cr, bt.ci, bt.zr, bt.zi, bt.zSquaredr, bt.zSquaredi, bt.dist, bt.savedr, bt.savedi, bt.epsilon, bt.pixelSize, NULL);
 }
 
 
-void Mandelbrot::calcScreenGMPBruteforce(const HighPrecDomain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
+void Mandelbrot::calcScreenGMPBruteforce(const HighPrecDomain& domain, const Resolution& res, const Range& r, const RenderOptions&, uint32_t* pixels) const {
     mpf_t cr, ci,
           zr, zi,
           zSquaredr, zSquaredi,
@@ -90,28 +85,24 @@ void Mandelbrot::calcScreenGMPBruteforce(const HighPrecDomain& domain, const Res
                 mpf_mul(zSquaredi, zi, zi);
             }
 
-            pixels[y * res.w + x] = calcColor(n);
+            pixels[y * res.w + x] = packIterations(n, nMax);
         }
     }
 
     mpf_clears(cr, ci, zr, zi, zSquaredr, zSquaredi, dist, pixelSize, NULL);
-    return;
-
-    // Prevent error
-    pixels = (uint32_t*)data;
 }
 
 // To call this function with initializer list (low precision domain)
-void Mandelbrot::calcScreenGMP(const Domain& domain, const Resolution& res, const Range& r, void* data, uint32_t* pixels) const {
+void Mandelbrot::calcScreenGMP(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
     HighPrecDomain d;
     mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
     mpf_set_d(d.rMin, domain.rMin); mpf_set_d(d.rMax, domain.rMax); mpf_set_d(d.iMin, domain.iMin); mpf_set_d(d.iMax, domain.iMax);
 
-    calcScreenGMP(d, res, r, data, pixels);
+    calcScreenGMP(d, res, r, options, pixels);
 
     mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
 }
 
 void Mandelbrot::calcScreenGMP(const Domain& domain, const Resolution& res, uint32_t* pixels) const {
-    calcScreenGMP(domain, res, {0, res.w, 0, res.h}, nullptr, pixels);
+    calcScreenGMP(domain, res, {0, res.w, 0, res.h}, RenderOptions(), pixels);
 }
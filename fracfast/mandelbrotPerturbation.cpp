@@ -0,0 +1,346 @@
+
+#include "mandelbrot.h"
+#include "threadPool.h"
+#include "types.h"
+
+#include <gmp.h>
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+
+// Pauldelbrot's glitch criterion: a pixel is glitched when |Z_n + d_n| < GLITCHTOLERANCE * |Z_n|
+static const double GLITCHTOLERANCE = 1e-3;
+// A frame gives up on its glitched pixels after this many reference orbits
+static const unsigned int MAXREFERENCES = 64;
+
+// Number of terms of the series approximation
+static const unsigned int SATERMS = 16;
+// The series may be used as long as it differs less than SATOLERANCE * |d_n| from the probes
+static const double SATOLERANCE = 1e-12;
+
+// Pixel sizes and differences below 2^FLOATEXPLIMIT are handled as FloatExp
+static const long FLOATEXPLIMIT = -960;
+
+// Pixels a thread takes at a time in perturbReference
+static const unsigned int PERTURBCHUNK = 256;
+
+
+// High precision orbit of a single point, rounded to doubles
+struct ReferenceOrbit {
+    std::vector<double> zr, zi;
+    std::vector<double> glitch;  // |Z_n|^2 * GLITCHTOLERANCE^2
+};
+
+
+// Truncated power series of the difference to the reference after skip iterations: d_skip = sum a_k * u^k for k = 1..SATERMS
+// The series is in u = dc / radius instead of dc, so the coefficients don't underflow at great depths
+template<typename T>
+struct SeriesApproximation {
+    iter_t skip;
+    T radius;
+    T ar[SATERMS], ai[SATERMS];
+};
+
+
+// Iterates c with GMP until it escapes or reaches nMax, storing Z_0 up to and including the last Z_n
+// Stops early when cancelled, the orbit is of no use then
+static void calcReferenceOrbit(const mpf_t cr, const mpf_t ci, const iter_t nMax, ReferenceOrbit& ref, const CancelToken* cancel) {
+    const mp_bitcnt_t prec = mpf_get_prec(cr);
+    mpf_t zr, zi, zSquaredr, zSquaredi, dist;
+    mpf_init2(zr, prec); mpf_init2(zi, prec); mpf_init2(zSquaredr, prec); mpf_init2(zSquaredi, prec); mpf_init2(dist, prec);
+    mpf_set_ui(zr, 0); mpf_set_ui(zi, 0); mpf_set_ui(zSquaredr, 0); mpf_set_ui(zSquaredi, 0);
+
+    ref.zr.clear(); ref.zi.clear(); ref.glitch.clear();
+    for(iter_t n = 0; ; n++) {
+        const double r = mpf_get_d(zr), i = mpf_get_d(zi);
+        ref.zr.push_back(r);
+        ref.zi.push_back(i);
+        ref.glitch.push_back(((r * r) + (i * i)) * GLITCHTOLERANCE * GLITCHTOLERANCE);
+
+        mpf_add(dist, zSquaredr, zSquaredi);
+        if(n == nMax || mpf_cmp_ui(dist, 4) > 0 || isCancelled(cancel))
+            break;
+
+        // z = z^2 + c
+        mpf_mul(zi, zr, zi);
+        mpf_mul_2exp(zi, zi, 1);
+        mpf_sub(zr, zSquaredr, zSquaredi);
+
+        mpf_add(zr, zr, cr);
+        mpf_add(zi, zi, ci);
+
+        mpf_mul(zSquaredr, zr, zr);
+        mpf_mul(zSquaredi, zi, zi);
+    }
+
+    mpf_clears(zr, zi, zSquaredr, zSquaredi, dist, NULL);
+}
+
+
+// Sum of a_k * u^k, with Horner's method
+template<typename T>
+static inline void evalSeries(const T ar[SATERMS], const T ai[SATERMS], const T& ur, const T& ui, T& dr, T& di) {
+    dr = ar[SATERMS - 1];
+    di = ai[SATERMS - 1];
+    for(int k = SATERMS - 2; k >= 0; k--) {
+        const T t = (dr * ur) - (di * ui) + ar[k];
+        di = (dr * ui) + (di * ur) + ai[k];
+        dr = t;
+    }
+
+    const T t = (dr * ur) - (di * ui);
+    di = (dr * ui) + (di * ur);
+    dr = t;
+}
+
+
+// Iterates the coefficients of the series along the reference together with the probes, which are iterated exactly,
+// for as long as the series matches every probe and none of them escapes or glitches
+// The probes are given as their dc; the radius of the series is the largest |dc|
+template<typename T>
+static void calcSeries(const ReferenceOrbit& ref, const T (*probes)[2], const unsigned int count, const iter_t nMax, SeriesApproximation<T>& sa) {
+    sa.skip = 0;
+    sa.radius = 0;
+    for(unsigned int k = 0; k < SATERMS; k++)
+        sa.ar[k] = sa.ai[k] = 0;
+
+    std::vector<T> ur(count), ui(count), dr(count, 0.0), di(count, 0.0);
+    for(unsigned int p = 0; p < count; p++)
+        sa.radius = std::max(sa.radius, (T)hypot(probes[p][0], probes[p][1]));  // Squares underflow at great depths
+    if(!(sa.radius > 0))
+        return;
+    for(unsigned int p = 0; p < count; p++) {
+        ur[p] = probes[p][0] / sa.radius;
+        ui[p] = probes[p][1] / sa.radius;
+    }
+
+    const size_t last = std::min(ref.zr.size(), (size_t)nMax) - 1;  // The orbit has nMax + 1 entries, which can overflow iter_t
+    T ar[SATERMS], ai[SATERMS];
+    std::vector<T> drNew(count), diNew(count);
+    for(iter_t n = 0; n < last; n++) {
+        const double Zr = ref.zr[n], Zi = ref.zi[n];
+
+        // a_1 = 2Z * a_1 + radius, a_k = 2Z * a_k + sum of a_i * a_j with i + j = k
+        for(unsigned int k = 0; k < SATERMS; k++) {
+            ar[k] = 2.0 * ((Zr * sa.ar[k]) - (Zi * sa.ai[k]));
+            ai[k] = 2.0 * ((Zr * sa.ai[k]) + (Zi * sa.ar[k]));
+            for(unsigned int i = 0; i < k; i++) {
+                ar[k] = ar[k] + (sa.ar[i] * sa.ar[k - 1 - i]) - (sa.ai[i] * sa.ai[k - 1 - i]);
+                ai[k] = ai[k] + (sa.ar[i] * sa.ai[k - 1 - i]) + (sa.ai[i] * sa.ar[k - 1 - i]);
+            }
+        }
+        ar[0] = ar[0] + sa.radius;
+
+        bool valid = true;
+        for(unsigned int p = 0; p < count && valid; p++) {
+            const T tr = (2.0 * Zr) + dr[p],
+                    ti = (2.0 * Zi) + di[p];
+            drNew[p] = (tr * dr[p]) - (ti * di[p]) + probes[p][0];
+            diNew[p] = (tr * di[p]) + (ti * dr[p]) + probes[p][1];
+
+            const T zr = ref.zr[n + 1] + drNew[p],
+                    zi = ref.zi[n + 1] + diNew[p];
+            const T dist = (zr * zr) + (zi * zi);
+
+            // Compared relative to the radius, as the squares of d_n may underflow
+            T sr, si;
+            evalSeries(ar, ai, ur[p], ui[p], sr, si);
+            const T er = (sr - drNew[p]) / sa.radius, ei = (si - diNew[p]) / sa.radius,
+                    sizer = drNew[p] / sa.radius, sizei = diNew[p] / sa.radius;
+            const T error = (er * er) + (ei * ei),
+                    size = (sizer * sizer) + (sizei * sizei);
+
+            // Also catches the coefficients overflowing
+            valid = dist <= 4.0 && dist >= ref.glitch[n + 1] && error <= size * SATOLERANCE * SATOLERANCE;
+        }
+        if(!valid)
+            break;
+
+        for(unsigned int k = 0; k < SATERMS; k++) {
+            sa.ar[k] = ar[k];
+            sa.ai[k] = ai[k];
+        }
+        dr.swap(drNew);
+        di.swap(diNew);
+        sa.skip = n + 1;
+    }
+}
+
+
+// Iterates the difference d between the pixel and the reference orbit from iteration n on: d = (2Z + d) * d + dc
+// Returns the escape time, and sets glitch to |z|^2 / |Z|^2 if the pixel glitched (or 1 if it outlived the reference), -1 otherwise
+static inline iter_t perturbPixel(const ReferenceOrbit& ref, const double dcr, const double dci, iter_t n, double dr, double di, const iter_t nMax, double& glitch) {
+    const double* const Zr = ref.zr.data();
+    const double* const Zi = ref.zi.data();
+    const size_t length = ref.zr.size();
+
+    glitch = -1;
+
+    for(; n < nMax; n++) {
+        if(n == length) {
+            glitch = 1;
+            break;
+        }
+
+        const double zr = Zr[n] + dr,
+                     zi = Zi[n] + di;
+        const double dist = (zr * zr) + (zi * zi);
+        if(dist > 4.0)
+            break;
+        if(dist < ref.glitch[n]) {
+            glitch = dist / ((Zr[n] * Zr[n]) + (Zi[n] * Zi[n]));
+            break;
+        }
+
+        // 2Z + d = Z + z
+        const double tr = Zr[n] + zr,
+                     ti = Zi[n] + zi;
+        const double drNew = (tr * dr) - (ti * di) + dcr;
+        di = (tr * di) + (ti * dr) + dci;
+        dr = drNew;
+    }
+
+    return n;
+}
+
+
+// Same for differences too small for a double, which are iterated as FloatExp until they fit in one
+// Until then |Z + d| = |Z| in double precision, so the pixel can't escape or glitch before the reference does
+static inline iter_t perturbPixel(const ReferenceOrbit& ref, const FloatExp& dcr, const FloatExp& dci, iter_t n, FloatExp dr, FloatExp di, const iter_t nMax, double& glitch) {
+    const size_t length = ref.zr.size();
+
+    for(; (size_t)n + 1 < length && n < nMax && dr.e < FLOATEXPLIMIT && di.e < FLOATEXPLIMIT; n++) {
+        const FloatExp tr = dr + (2.0 * ref.zr[n]),
+                       ti = di + (2.0 * ref.zi[n]);
+        const FloatExp drNew = (tr * dr) - (ti * di) + dcr;
+        di = (tr * di) + (ti * dr) + dci;
+        dr = drNew;
+    }
+
+    return perturbPixel(ref, dcr.toDouble(), dci.toDouble(), n, dr.toDouble(), di.toDouble(), nMax, glitch);
+}
+
+
+// Calculates the pixels in todo against the reference at (refX, refY), starting with a series approximation probed at the corners of their bounding box
+// T is double, or FloatExp when the pixel size doesn't fit in a double; returns the number of iterations skipped
+template<typename T>
+static iter_t perturbReference(const Mandelbrot& m, const ReferenceOrbit& ref, const unsigned int refX, const unsigned int refY, const T& ps,
+                               const Resolution& res, const Range& r, const std::vector<unsigned int>& todo, std::vector<double>& glitch, uint32_t* pixels,
+                               const CancelToken* cancel) {
+    const unsigned int dX = r.xMax - r.xMin;
+    const iter_t nMax = m.getnMax();
+
+    unsigned int xMin = r.xMax, xMax = r.xMin, yMin = r.yMax, yMax = r.yMin;
+    for(auto& p : todo) {
+        xMin = std::min(xMin, r.xMin + (p % dX)); xMax = std::max(xMax, r.xMin + (p % dX));
+        yMin = std::min(yMin, r.yMin + (p / dX)); yMax = std::max(yMax, r.yMin + (p / dX));
+    }
+    const T probes[4][2] = {{((double)xMin - (double)refX) * ps, ((double)refY - (double)yMin) * ps},
+                            {((double)xMax - (double)refX) * ps, ((double)refY - (double)yMin) * ps},
+                            {((double)xMin - (double)refX) * ps, ((double)refY - (double)yMax) * ps},
+                            {((double)xMax - (double)refX) * ps, ((double)refY - (double)yMax) * ps}};
+    SeriesApproximation<T> sa;
+    calcSeries(ref, probes, 4, nMax, sa);
+
+    // The threads of the pool take PERTURBCHUNK pixels at a time, as pixels close to the set take far longer than the others
+    const unsigned int count = todo.size();
+    std::atomic<unsigned int> next(0);
+    threadPool().run(threadPool().size(), [&](const unsigned int) {
+        for(unsigned int first = next.fetch_add(PERTURBCHUNK); first < count && !isCancelled(cancel); first = next.fetch_add(PERTURBCHUNK)) {
+            const unsigned int last = std::min(first + PERTURBCHUNK, count);
+            for(unsigned int i = first; i < last; i++) {
+                const unsigned int x = r.xMin + (todo[i] % dX),
+                                   y = r.yMin + (todo[i] / dX);
+                const T dcr = ((double)x - (double)refX) * ps,
+                        dci = ((double)refY - (double)y) * ps;
+
+                T dr = 0.0, di = 0.0;
+                if(sa.skip > 0)
+                    evalSeries(sa.ar, sa.ai, dcr / sa.radius, dci / sa.radius, dr, di);
+
+                pixels[y * res.w + x] = packIterations(perturbPixel(ref, dcr, dci, sa.skip, dr, di, nMax, glitch[todo[i]]), nMax);
+            }
+        }
+    });
+
+    return sa.skip;
+}
+
+
+// The first reference is the center pixel of the range; pixels which glitch against it are recalculated against a new reference,
+// which is the glitched pixel closest to the set (smallest |z| / |Z|), until none are left
+// Shapes are not checked, as they can't be evaluated exactly in double precision at these depths
+void Mandelbrot::calcScreenPerturbation(const HighPrecDomain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
+    PerturbationStats* const stats = options.stats;
+    const CancelToken* const cancel = options.cancel;
+    const unsigned int dX = r.xMax - r.xMin,
+                       dY = r.yMax - r.yMin;
+
+    // The reference needs enough bits to resolve a pixel, with some left for the rounding of the iterations
+    mpf_t pixelSize, cr, ci;
+    mpf_init2(pixelSize, mpf_get_prec(domain.rMin));
+    mpf_sub(pixelSize, domain.rMax, domain.rMin);
+    mpf_div_ui(pixelSize, pixelSize, res.w);
+
+    const FloatExp ps(pixelSize);
+    const mp_bitcnt_t prec = std::max((long)mpf_get_prec(domain.rMin), 64 - ps.e);
+    mpf_init2(cr, prec); mpf_init2(ci, prec);
+
+    // Pixels left to calculate, as index in the range, with their glitch value of the last pass
+    std::vector<unsigned int> todo(dX * dY);
+    for(unsigned int i = 0; i < dX * dY; i++)
+        todo[i] = i;
+    std::vector<double> glitch(dX * dY);
+
+    unsigned int refX = r.xMin + (dX / 2),
+                 refY = r.yMin + (dY / 2);
+    unsigned int references = 0;
+    ReferenceOrbit ref;
+    if(stats != nullptr)
+        stats->skipped = 0;
+    while(!todo.empty() && references < MAXREFERENCES && !isCancelled(cancel)) {
+        // c = (rMin + refX * pixelSize, iMax - refY * pixelSize)
+        mpf_mul_ui(cr, pixelSize, refX);
+        mpf_add(cr, domain.rMin, cr);
+        mpf_mul_ui(ci, pixelSize, refY);
+        mpf_sub(ci, domain.iMax, ci);
+        calcReferenceOrbit(cr, ci, nMax, ref, cancel);
+        if(isCancelled(cancel))
+            break;
+
+        iter_t skipped;
+        if(ps.e < FLOATEXPLIMIT)
+            skipped = perturbReference(*this, ref, refX, refY, ps, res, r, todo, glitch, pixels, cancel);
+        else
+            skipped = perturbReference(*this, ref, refX, refY, ps.toDouble(), res, r, todo, glitch, pixels, cancel);
+
+        if(references == 0 && stats != nullptr)
+            stats->skipped = skipped;
+        references++;
+
+        // Keep the glitched pixels and pick the next reference
+        std::vector<unsigned int> glitched;
+        double minGlitch = std::numeric_limits<double>::max();
+        for(auto& p : todo)
+            if(glitch[p] >= 0) {
+                glitched.push_back(p);
+                if(glitch[p] < minGlitch) {
+                    minGlitch = glitch[p];
+                    refX = r.xMin + (p % dX);
+                    refY = r.yMin + (p / dX);
+                }
+            }
+        todo.swap(glitched);
+    }
+
+    if(stats != nullptr) {
+        stats->references = references;
+        stats->glitched = todo.size();
+    }
+
+    mpf_clears(pixelSize, cr, ci, NULL);
+}
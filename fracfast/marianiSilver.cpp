@@ -0,0 +1,130 @@
+
+#include "fractal.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+// Rectangles with at most this many pixels inside their edge are calculated instead of split further, with one call to the vector kernel
+static const unsigned int MINSUBDIVIDE = BATCHSIZE;
+
+struct MarianiSilver {
+    const Fractal* fractal;
+    uint32_t* pixels;
+    double rMin, iMax, pixelSize;
+    unsigned int w;
+    const RenderOptions& options;
+};
+
+
+// Calculates count pixels from (x, y) to the right, or down, in batches for the vector kernels
+static void calcLine(const MarianiSilver& ms, const unsigned int x, const unsigned int y, const unsigned int count, const bool down) {
+    double cr[BATCHSIZE], ci[BATCHSIZE];
+    uint32_t colors[BATCHSIZE];
+
+    for(unsigned int first = 0; first < count; first += BATCHSIZE) {
+        const unsigned int n = std::min(BATCHSIZE, count - first);
+        for(unsigned int i = 0; i < n; i++) {
+            const unsigned int pX = (down ? x : x + first + i),
+                               pY = (down ? y + first + i : y);
+            cr[i] = ms.rMin + (pX * ms.pixelSize);
+            ci[i] = ms.iMax - (pY * ms.pixelSize);
+        }
+
+        ms.fractal->calcPixels(cr, ci, n, ms.pixelSize, ms.options, colors);
+        for(unsigned int i = 0; i < n; i++)
+            ms.pixels[(down ? (y + first + i) * ms.w + x : y * ms.w + x + first + i)] = colors[i];
+    }
+}
+
+// Calculates the pixels inside the edge of r, at most BATCHSIZE
+static void calcInside(const MarianiSilver& ms, const Range& r) {
+    double cr[BATCHSIZE], ci[BATCHSIZE];
+    uint32_t colors[BATCHSIZE];
+
+    unsigned int n = 0;
+    for(unsigned int y = r.yMin + 1; y < r.yMax - 1; y++) {
+        for(unsigned int x = r.xMin + 1; x < r.xMax - 1; x++) {
+            cr[n] = ms.rMin + (x * ms.pixelSize);
+            ci[n] = ms.iMax - (y * ms.pixelSize);
+            n++;
+        }
+    }
+
+    ms.fractal->calcPixels(cr, ci, n, ms.pixelSize, ms.options, colors);
+
+    n = 0;
+    for(unsigned int y = r.yMin + 1; y < r.yMax - 1; y++)
+        for(unsigned int x = r.xMin + 1; x < r.xMax - 1; x++)
+            ms.pixels[y * ms.w + x] = colors[n++];
+}
+
+// Whether all pixels on the edge of r have the same value
+static bool uniformEdge(const MarianiSilver& ms, const Range& r, uint32_t& value) {
+    value = ms.pixels[r.yMin * ms.w + r.xMin];
+
+    for(unsigned int x = r.xMin; x < r.xMax; x++)
+        if(ms.pixels[r.yMin * ms.w + x] != value || ms.pixels[(r.yMax - 1) * ms.w + x] != value)
+            return false;
+    for(unsigned int y = r.yMin + 1; y < r.yMax - 1; y++)
+        if(ms.pixels[y * ms.w + r.xMin] != value || ms.pixels[y * ms.w + r.xMax - 1] != value)
+            return false;
+
+    return true;
+}
+
+// The edge of r is calculated already
+static void subdivide(const MarianiSilver& ms, const Range& r) {
+    const unsigned int dX = r.xMax - r.xMin,
+                       dY = r.yMax - r.yMin;
+    if(dX <= 2 || dY <= 2 || isCancelled(ms.options.cancel))
+        return;  // Nothing inside the edge
+
+    uint32_t value;
+    if(uniformEdge(ms, r, value)) {
+        for(unsigned int y = r.yMin + 1; y < r.yMax - 1; y++)
+            std::fill(ms.pixels + y * ms.w + r.xMin + 1, ms.pixels + y * ms.w + r.xMax - 1, value);
+        return;
+    }
+
+    if((dX - 2) * (dY - 2) <= MINSUBDIVIDE) {
+        calcInside(ms, r);
+        return;
+    }
+
+    // Split the longest side in two, the line in the middle is the edge of both halves
+    if(dX >= dY) {
+        const unsigned int mid = r.xMin + dX / 2;
+        calcLine(ms, mid, r.yMin + 1, dY - 2, true);
+        subdivide(ms, {r.xMin, mid + 1, r.yMin, r.yMax});
+        subdivide(ms, {mid, r.xMax, r.yMin, r.yMax});
+    }
+    else {
+        const unsigned int mid = r.yMin + dY / 2;
+        calcLine(ms, r.xMin + 1, mid, dX - 2, false);
+        subdivide(ms, {r.xMin, r.xMax, r.yMin, mid + 1});
+        subdivide(ms, {r.xMin, r.xMax, mid, r.yMax});
+    }
+}
+
+
+void Fractal::calcScreenMarianiSilver(const Domain& domain, const Resolution& res, const Range& r, const RenderOptions& options, uint32_t* pixels) const {
+    const MarianiSilver ms = {this, pixels, domain.rMin, domain.iMax, (domain.rMax - domain.rMin) / (double)res.w, res.w, options};
+    const unsigned int dX = r.xMax - r.xMin,
+                       dY = r.yMax - r.yMin;
+    if(dX == 0 || dY == 0)
+        return;
+
+    // The edge of the whole range
+    calcLine(ms, r.xMin, r.yMin, dX, false);
+    if(dY > 1)
+        calcLine(ms, r.xMin, r.yMax - 1, dX, false);
+    if(dY > 2) {
+        calcLine(ms, r.xMin, r.yMin + 1, dY - 2, true);
+        if(dX > 1)
+            calcLine(ms, r.xMax - 1, r.yMin + 1, dY - 2, true);
+    }
+
+    subdivide(ms, r);
+}
@@ -1,63 +1,38 @@
-
 #include "queue.h"
 
 
-Queue::Queue() {
-    head = nullptr;
-    tail = nullptr;
-}
+static const unsigned int INITIALCAPACITY = 1024;
 
-Queue::Queue(unsigned int i) {
-    head = new elem(i);
 
-    tail = head;
+Queue::Queue() : Queue(INITIALCAPACITY) {
 }
 
-Queue::~Queue() {
-    elem* iter;
-
-    elem* save = nullptr;
-    for(iter = head; iter != tail; iter = save) {
-        save = iter->prev;
-
-        delete iter;
-    }
-
-    delete iter;
+Queue::Queue(const unsigned int capacity) : mask(0), head(0), tail(0) {
+    reset(capacity);
 }
 
 
-bool Queue::empty() const {
-    return head == nullptr;
-}
+void Queue::reset(const unsigned int capacity) {
+    head = tail = 0;
 
+    unsigned int size = (buffer.empty() ? 1 : buffer.size());
+    while(size < capacity)
+        size *= 2;
 
-void Queue::push(unsigned int i) {
-    if(head == nullptr) {
-        head = new elem(i);
-
-        tail = head;
-    }
-    else {
-        tail->prev = new elem(i);
-        tail = tail->prev;
-    }
+    if(size != buffer.size())
+        buffer.resize(size);
+    mask = size - 1;
 }
 
-void Queue::pop() {
-    if(head == nullptr)
-        return;
-
-    elem* save = head;
-
-    head = head->prev;
-    if(head == nullptr)
-        tail = nullptr;
-
-    delete save;
-}
 
+// Moves the elements to the start of a buffer twice as large, so they don't wrap around anymore
+void Queue::grow() {
+    std::vector<unsigned int> larger(buffer.size() * 2);
+    for(unsigned int i = head; i != tail; i++)
+        larger[i - head] = buffer[i & mask];
 
-unsigned int Queue::front() const {
-    return head->value;
+    tail -= head;
+    head = 0;
+    buffer.swap(larger);
+    mask = buffer.size() - 1;
 }
@@ -3,32 +3,48 @@
 #define QUEUE_H
 
 
-struct elem {
-    unsigned int value;
-    elem* prev;
-
-    elem() {prev = nullptr;};
-    elem(unsigned int v) {value = v; prev = nullptr;};
-};
+#include <vector>
 
 
+// FIFO of pixel indices for the border trace, in a ring buffer
+// The capacity is a power of 2, so wrapping around is a mask. It only grows (doubling) when it's full, and reset keeps the memory,
+// so a queue that is reused for every tile stops allocating after the first few
 class Queue {
     public:
         Queue();
-        Queue(unsigned int i);
-        ~Queue();
+        explicit Queue(const unsigned int capacity);
 
-        bool empty() const;
-        
-        void push(const unsigned int i);
-        void pop();
+        // Empties the queue and makes room for at least capacity elements
+        void reset(const unsigned int capacity);
 
-        unsigned int front() const;
+        bool empty() const {
+            return head == tail;
+        }
+        
+        void push(const unsigned int i) {
+            if(tail - head > mask)
+                grow();
+            buffer[tail & mask] = i;
+            tail++;
+        }
+
+        // Not for an empty queue
+        void pop() {
+            head++;
+        }
+
+        // Not for an empty queue
+        unsigned int front() const {
+            return buffer[head & mask];
+        }
 
     private:
-        elem* head;
-        elem* tail;
+        std::vector<unsigned int> buffer;
+        unsigned int mask;        // Capacity - 1
+        unsigned int head, tail;  // Only count up, the elements are at [head, tail) modulo the capacity
+
+        void grow();
 };
 
 
-#endif  // QUEUE_H
\ No newline at end of file
+#endif  // QUEUE_H
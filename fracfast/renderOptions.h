@@ -0,0 +1,41 @@
+
+#ifndef RENDER_OPTIONS_H
+#define RENDER_OPTIONS_H
+
+
+#include "shapes.h"
+#include "types.h"
+
+
+struct PerturbationStats;
+
+
+// What the values of a frame are, packed iteration counts or exterior distances (colorizer.h)
+enum class Coloring {
+    escapeTime,
+    distance
+};
+
+// Number types a frame can be rendered with, from cheapest to most precise
+enum class Precision {
+    Double,
+    DoubleDouble,
+    GMP  // Perturbation, with the reference orbit in GMP
+};
+
+
+// Everything a render takes besides where and how large, passed by const reference from the render functions down to calcPixel
+// Copied only to narrow it for a tile (cullShapes)
+struct RenderOptions {
+    ShapeSet shapes = NOSHAPES;                // Mandelbrot only; culled again for every tile
+    Coloring coloring = Coloring::escapeTime;  // Of the frame; the calcScreen functions each calculate one of them
+    Precision precision = Precision::Double;   // Tier the frame was planned in
+    const CancelToken* cancel = nullptr;       // Checked between tiles and rows; a cancelled render leaves the rest of the pixels as they are
+    PerturbationStats* stats = nullptr;        // Filled by calcScreenPerturbation, if set
+
+    RenderOptions() {}
+    explicit RenderOptions(const ShapeSet s, const CancelToken* c = nullptr) : shapes(s), cancel(c) {}
+};
+
+
+#endif  // RENDER_OPTIONS_H
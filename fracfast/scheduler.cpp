@@ -0,0 +1,162 @@
+#include "scheduler.h"
+#include "threadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+
+// Tiles per thread made before rendering starts, the rest is split on demand
+static const int TILESPERTHREAD = 4;
+
+
+struct Tile {
+    Range range;
+    int depth;  // Times split from the full range
+};
+
+struct TileDeque {
+    std::deque<Tile> tiles;
+    std::mutex mutex;
+};
+
+
+static inline bool canSplit(const Tile& t, const int splits) {
+    return t.depth < splits && (t.range.xMax - t.range.xMin > 1 || t.range.yMax - t.range.yMin > 1);
+}
+
+// If there are more pixels in the x axis, split it in 2, otherwise split the y axis
+static inline void splitTile(const Tile& t, Tile& a, Tile& b) {
+    const Range& r = t.range;
+    if(r.xMax - r.xMin > r.yMax - r.yMin) {
+        a.range = {r.xMin, r.xMin + ((r.xMax - r.xMin) / 2), r.yMin, r.yMax};
+        b.range = {r.xMin + ((r.xMax - r.xMin) / 2), r.xMax, r.yMin, r.yMax};
+    }
+    else {
+        a.range = {r.xMin, r.xMax, r.yMin, r.yMin + ((r.yMax - r.yMin) / 2)};
+        b.range = {r.xMin, r.xMax, r.yMin + ((r.yMax - r.yMin) / 2), r.yMax};
+    }
+    a.depth = b.depth = t.depth + 1;
+}
+
+
+void renderTiles(const Range& range, const TileFunction& renderTile, int cores, int splits, const CancelToken* cancel) {
+    if(cores <= ALLTHREADS)
+        cores = threadPool().size();
+    if(splits <= AUTOSPLITS) {
+        splits = 0;
+        for(unsigned int pixels = (range.xMax - range.xMin) * (range.yMax - range.yMin); pixels > MINTILEPIXELS; pixels /= 2)
+            splits++;
+    }
+
+    // Split up front until every thread has a few tiles
+    std::vector<Tile> tiles = {{range, 0}};
+    while(tiles.size() < (unsigned int)(TILESPERTHREAD * cores)) {
+        std::vector<Tile> newTiles;
+        for(auto& t : tiles) {
+            if(!canSplit(t, splits)) {
+                newTiles.push_back(t);
+                continue;
+            }
+            Tile a, b;
+            splitTile(t, a, b);
+            newTiles.push_back(a);
+            newTiles.push_back(b);
+        }
+        if(newTiles.size() == tiles.size())
+            break;
+        tiles = newTiles;
+    }
+
+    // Deal them out in order, so neighbouring tiles (which take about as long) end up at different threads
+    std::vector<TileDeque> deques(cores);
+    for(unsigned int i = 0; i < tiles.size(); i++)
+        deques[i % cores].tiles.push_back(tiles[i]);
+
+    std::atomic<unsigned int> pending(tiles.size());  // Tiles not rendered yet, in a deque or being rendered
+    std::atomic<unsigned int> queued(tiles.size());   // Tiles in a deque
+    std::atomic<int> idle(0);                         // Threads looking for work
+
+    // Threads that found every deque empty sleep on this until a tile is queued or the last one is done, instead of spinning
+    // The counters are changed outside idleMutex, so it's taken before notifying, to not notify between a check and the wait
+    std::mutex idleMutex;
+    std::condition_variable work;
+    auto notifyIdle = [&]() {
+        { std::lock_guard<std::mutex> guard(idleMutex); }
+        work.notify_all();
+    };
+
+    threadPool().run(cores, [&](const unsigned int self) {
+        TileDeque& own = deques[self];
+        bool isIdle = false;
+
+        while(pending > 0) {
+            Tile t;
+            bool found = false, stolen = false;
+
+            {
+                std::lock_guard<std::mutex> guard(own.mutex);
+                if(!own.tiles.empty()) {
+                    t = own.tiles.back();
+                    own.tiles.pop_back();
+                    queued--;
+                    found = true;
+                }
+            }
+
+            // Steal the oldest (largest) tile of another thread
+            for(int i = 1; i < cores && !found; i++) {
+                TileDeque& other = deques[(self + i) % cores];
+                std::lock_guard<std::mutex> guard(other.mutex);
+                if(!other.tiles.empty()) {
+                    t = other.tiles.front();
+                    other.tiles.pop_front();
+                    queued--;
+                    found = stolen = true;
+                }
+            }
+
+            if(!found) {
+                if(!isIdle) {
+                    idle++;
+                    isIdle = true;
+                }
+                std::unique_lock<std::mutex> lock(idleMutex);
+                work.wait(lock, [&]() { return pending == 0 || queued > 0; });
+                continue;
+            }
+            if(isIdle) {
+                idle--;
+                isIdle = false;
+            }
+
+            // Split on demand: leave half of the tile for others when this thread has nothing else to give away and someone runs dry
+            bool split = false;
+            {
+                std::lock_guard<std::mutex> guard(own.mutex);
+                if(own.tiles.empty() && (stolen || idle > 0) && canSplit(t, splits)) {
+                    Tile a, b;
+                    splitTile(t, a, b);
+                    pending++;
+                    queued++;
+                    own.tiles.push_back(b);
+                    t = a;
+                    split = true;
+                }
+            }
+            if(split && idle > 0)
+                notifyIdle();
+
+            // After a cancel the remaining tiles are only taken off the deques, so every thread gets out quickly
+            if(!isCancelled(cancel))
+                renderTile(t.range);
+            if(--pending == 0)
+                notifyIdle();
+        }
+
+        if(isIdle)
+            idle--;
+    });
+}
@@ -0,0 +1,28 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+
+#include "types.h"
+
+#include <functional>
+
+
+// Calculates one tile of the screen; tiles never overlap and together cover the range given to renderTiles
+typedef std::function<void(const Range& tile)> TileFunction;
+
+
+// For cores: use every thread of the library's thread pool
+const int ALLTHREADS = 0;
+// For splits: split tiles down to about MINTILEPIXELS pixels
+const int AUTOSPLITS = -1;
+const unsigned int MINTILEPIXELS = 64 * 64;
+
+
+// Calls renderTile for tiles covering range on cores threads of the thread pool, with work stealing
+// Every thread has its own deque of tiles: it takes tiles from the back of its own deque and steals from the front of the others when it runs dry
+// Only a few tiles per thread are made up front; a tile is split in half when a thread runs dry, until it has been split splits times
+// Tiles not started before cancel is cancelled are skipped; renderTile should check it too, to stop inside a tile
+void renderTiles(const Range& range, const TileFunction& renderTile, int cores = ALLTHREADS, int splits = AUTOSPLITS, const CancelToken* cancel = nullptr);
+
+
+#endif  // SCHEDULER_H
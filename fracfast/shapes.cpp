@@ -1,15 +1,167 @@
 
 #include "shapes.h"
 
+#include <cmath>
+#include <vector>
+#include <algorithm>
 
-bool inCardioid(const double z[2]) {
-    const double q = ((z[0] - 0.25) * (z[0] - 0.25)) + (z[1] * z[1]);
-    return q * (q + (z[0] - 0.25)) < z[1] * z[1] * 0.25;
+
+// Disc inside a hyperbolic component, above the real axis or on it
+struct Bulb {
+    double cr, ci;
+    double radius;
+    unsigned int period;
+};
+
+#include "bulbTable.cpp"
+
+
+// Bounding volume hierarchy over the bulbs of the table: the box of a node contains all its bulbs, so only the nodes
+// whose box contains a point are searched, O(log n) of them for most points
+struct BulbNode {
+    Domain box;
+    unsigned int first, count;  // Bulbs of a leaf, in bulbOrder
+    unsigned int right;         // Second child of an inner node, the first one comes right after it
+};
+
+static const unsigned int BULBSPERLEAF = 4;
+static std::vector<unsigned int> bulbOrder;
+
+// Splits the bulbs [first, last) of bulbOrder at the median of the longer side of their box
+static void buildBulbTree(std::vector<BulbNode>& tree, const unsigned int first, const unsigned int last) {
+    Domain box = {HUGE_VAL, -HUGE_VAL, HUGE_VAL, -HUGE_VAL};
+    for(unsigned int i = first; i < last; i++) {
+        const Bulb& b = BULBTABLE[bulbOrder[i]];
+        box = {std::min(box.rMin, b.cr - b.radius), std::max(box.rMax, b.cr + b.radius),
+               std::min(box.iMin, b.ci - b.radius), std::max(box.iMax, b.ci + b.radius)};
+    }
+
+    const unsigned int node = tree.size();
+    tree.push_back({box, first, last - first, 0});
+    if(last - first <= BULBSPERLEAF)
+        return;
+
+    const bool alongR = box.rMax - box.rMin > box.iMax - box.iMin;
+    const unsigned int middle = (first + last) / 2;
+    std::nth_element(bulbOrder.begin() + first, bulbOrder.begin() + middle, bulbOrder.begin() + last, [alongR](unsigned int a, unsigned int b) {
+        return alongR ? BULBTABLE[a].cr < BULBTABLE[b].cr : BULBTABLE[a].ci < BULBTABLE[b].ci;
+    });
+
+    tree[node].count = 0;
+    buildBulbTree(tree, first, middle);
+    tree[node].right = tree.size();
+    buildBulbTree(tree, middle, last);
+}
+
+static std::vector<BulbNode> buildBulbTree() {
+    const unsigned int count = sizeof(BULBTABLE) / sizeof(BULBTABLE[0]);
+    for(unsigned int i = 0; i < count; i++)
+        bulbOrder.push_back(i);
+
+    std::vector<BulbNode> tree;
+    buildBulbTree(tree, 0, count);
+    return tree;
+}
+
+static const std::vector<BulbNode> bulbTree = buildBulbTree();
+
+bool inBulbs(const double z[2]) {
+    // The table only has the upper half
+    const double zr = z[0], zi = std::fabs(z[1]);
+
+    unsigned int stack[32];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        const BulbNode& node = bulbTree[stack[--top]];
+        if(zr < node.box.rMin || zr > node.box.rMax || zi < node.box.iMin || zi > node.box.iMax)
+            continue;
+
+        if(node.count == 0) {
+            stack[top++] = node.right;
+            stack[top++] = &node - bulbTree.data() + 1;
+            continue;
+        }
+
+        for(unsigned int i = node.first; i < node.first + node.count; i++) {
+            const Bulb& b = BULBTABLE[bulbOrder[i]];
+            if((zr - b.cr) * (zr - b.cr) + (zi - b.ci) * (zi - b.ci) < b.radius * b.radius)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+// Whether any disc of the table intersects domain, so tiles between the bulbs (most tiles of a zoom) skip inBulbs
+static bool bulbsIntersect(const Domain& domain) {
+    // Mirrored to the upper half, a domain across the real axis is covered by its part above it
+    const Domain d = {domain.rMin, domain.rMax, domain.iMin > 0.0 ? domain.iMin : (domain.iMax < 0.0 ? -domain.iMax : 0.0),
+                      std::max(domain.iMax, -domain.iMin)};
+
+    unsigned int stack[32];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        const BulbNode& node = bulbTree[stack[--top]];
+        if(node.box.rMin > d.rMax || d.rMin > node.box.rMax || node.box.iMin > d.iMax || d.iMin > node.box.iMax)
+            continue;
+
+        if(node.count == 0) {
+            stack[top++] = node.right;
+            stack[top++] = &node - bulbTree.data() + 1;
+            continue;
+        }
+
+        // Distance from the center to the closest point of the domain
+        for(unsigned int i = node.first; i < node.first + node.count; i++) {
+            const Bulb& b = BULBTABLE[bulbOrder[i]];
+            const double dr = b.cr - std::min(std::max(b.cr, d.rMin), d.rMax), di = b.ci - std::min(std::max(b.ci, d.iMin), d.iMax);
+            if(dr * dr + di * di < b.radius * b.radius)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+struct ShapeBounds {
+    ShapeSet shape;
+    Domain box;
+    bool (*intersects)(const Domain&);  // Finer test for the domains intersecting box, optional
+};
+
+static const ShapeBounds bounds[] = {
+    {CARDIOID, {-0.75, 0.25, -0.6496, 0.6496}, nullptr},  // The cardioid is highest at 3 * sqrt(3) / 8 = 0.649519...
+    {BULB2, {-1.25, -0.75, -0.25, 0.25}, nullptr},        // Disk of radius 0.25 around -1
+    {BULBS, {bulbTree[0].box.rMin, bulbTree[0].box.rMax, -bulbTree[0].box.iMax, bulbTree[0].box.iMax}, bulbsIntersect}  // Mirrored to below the real axis
+};
+
+ShapeSet cullShapes(const ShapeSet shapes, const Domain& domain) {
+    ShapeSet culled = shapes;
+    for(auto& b : bounds) {
+        if(!(shapes & b.shape))
+            continue;
+
+        bool intersects = b.box.rMin <= domain.rMax && domain.rMin <= b.box.rMax && b.box.iMin <= domain.iMax && domain.iMin <= b.box.iMax;
+        if(intersects && b.intersects != nullptr)
+            intersects = b.intersects(domain);
+        if(!intersects)
+            culled &= ~b.shape;
+    }
+
+    return culled;
 }
 
+ShapeSet cullShapes(const ShapeSet shapes, const Domain& domain, const Resolution& res, const Range& range) {
+    const double pixelSize = (domain.rMax - domain.rMin) / (double)res.w;
 
-bool in2Bulb(const double z[2]) {
-    return (z[0] * z[0]) + (2 * z[0]) + 1 + (z[1] * z[1]) < 0.0625;
+    // From the first to the last pixel of range
+    const Domain tile = {domain.rMin + (range.xMin * pixelSize), domain.rMin + ((range.xMax - 1) * pixelSize),
+                         domain.iMax - ((range.yMax - 1) * pixelSize), domain.iMax - (range.yMin * pixelSize)};
+    return cullShapes(shapes, tile);
 }
 
 
@@ -3,15 +3,44 @@
 #define SHAPES_H
 
 
-#include <vector>
+#include "types.h"
 
+#include <cstdint>
 
-typedef std::vector<bool (*)(const double[2])> ShapeVector;
+
+// Shapes inside the set, a bit each. A set of them is a plain value instead of a vector of function pointers, so copying
+// it is free and inShapes checks it with the predicates inlined, in the hot loops as well
+typedef uint8_t ShapeSet;
+
+const ShapeSet NOSHAPES = 0;
+const ShapeSet CARDIOID = 0b001;  // inCardioid
+const ShapeSet BULB2    = 0b010;  // in2Bulb
+const ShapeSet BULBS    = 0b100;  // inBulbs
+const ShapeSet ALLSHAPES = CARDIOID | BULB2 | BULBS;
 
 
 // Shapes
-bool inCardioid(const double z[2]);
-bool in2Bulb(const double z[2]);
+inline bool inCardioid(const double z[2]) {
+    const double q = ((z[0] - 0.25) * (z[0] - 0.25)) + (z[1] * z[1]);
+    return q * (q + (z[0] - 0.25)) < z[1] * z[1] * 0.25;
+}
+
+inline bool in2Bulb(const double z[2]) {
+    return (z[0] * z[0]) + (2 * z[0]) + 1 + (z[1] * z[1]) < 0.0625;
+}
+
+// Discs inside the bulbs and minibrots of period 3 and up, from the table in bulbTable.cpp (generated by genBulbs.cpp)
+bool inBulbs(const double z[2]);
+
+// Whether z is in any of shapes; the largest and cheapest shapes are checked first
+inline bool inShapes(const ShapeSet shapes, const double z[2]) {
+    return ((shapes & CARDIOID) && inCardioid(z)) || ((shapes & BULB2) && in2Bulb(z)) || ((shapes & BULBS) && inBulbs(z));
+}
+
+// Shapes whose bounding box intersects domain; a point outside every box can't be in a shape, so the others are only a waste of time
+ShapeSet cullShapes(const ShapeSet shapes, const Domain& domain);
+// Same for the pixels of range, in a screen of res showing domain
+ShapeSet cullShapes(const ShapeSet shapes, const Domain& domain, const Resolution& res, const Range& range);
 
 
 #endif  // SHAPES_H
@@ -0,0 +1,183 @@
+
+#include "fractal.h"
+#include "kernels.h"
+#include "threadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+
+// Set on a pixel by the thread that calculates it, before COLORED is set when its value is written
+static const uint8_t CLAIMED = 0b100;
+
+// Border trace of a whole range, shared by the threads of the pool
+// Pixels are claimed with atomics on their state, so each one is calculated once and there are no tile edges to calculate
+struct SharedBorderTrace {
+    uint32_t* pixels;
+    std::unique_ptr<std::atomic<uint8_t>[]> state;  // COLORED, QUEUED and CLAIMED of every pixel of the screen
+    // Every pixel is queued at most once, so the queue never wraps around; a slot is pixel + 1 once it's pushed, 0 before
+    std::unique_ptr<std::atomic<unsigned int>[]> queue;
+    std::atomic<unsigned int> head, tail;
+    std::atomic<unsigned int> pending;  // Pixels queued and not checked yet, including the ones a thread is checking
+    std::atomic<int> idle;               // Threads waiting for pixels to be queued
+
+    // Like the idle threads of the scheduler, threads that find the queue empty sleep until pixels are queued or the trace is done
+    std::mutex idleMutex;
+    std::condition_variable work;
+
+    double rMin, iMax, pixelSize;
+    unsigned int w;
+    Range r;
+    const RenderOptions* options;
+};
+
+
+// Whether pixel still has to be queued; only true for the first thread asking
+static bool markQueued(SharedBorderTrace& st, const unsigned int pixel) {
+    if(st.state[pixel].load(std::memory_order_relaxed) & QUEUED)
+        return false;
+    return !(st.state[pixel].fetch_or(QUEUED, std::memory_order_relaxed) & QUEUED);
+}
+
+// The counters are changed outside idleMutex, so it's taken before notifying, to not notify between a check and the wait
+static void notifyIdle(SharedBorderTrace& st) {
+    { std::lock_guard<std::mutex> guard(st.idleMutex); }
+    st.work.notify_all();
+}
+
+// Pending goes up before the pixels can be taken, so it can't reach 0 while there's work left
+static void push(SharedBorderTrace& st, const unsigned int* pixels, const unsigned int count) {
+    if(count == 0)
+        return;
+
+    st.pending += count;
+    const unsigned int first = st.tail.fetch_add(count);
+    for(unsigned int i = 0; i < count; i++)
+        st.queue[first + i].store(pixels[i] + 1, std::memory_order_release);
+
+    if(st.idle > 0)
+        notifyIdle(st);
+}
+
+// Takes up to max pixels off the queue; returns how many
+static unsigned int pop(SharedBorderTrace& st, unsigned int* pixels, const unsigned int max) {
+    unsigned int h = st.head.load(), count;
+    do {
+        const unsigned int t = st.tail.load();
+        if(h >= t)
+            return 0;
+        count = std::min(max, t - h);
+    } while(!st.head.compare_exchange_weak(h, h + count));
+
+    // The slots are taken, but the threads that took them may not have written their pixels yet
+    for(unsigned int i = 0; i < count; i++) {
+        unsigned int slot;
+        while((slot = st.queue[h + i].load(std::memory_order_acquire)) == 0)
+            std::this_thread::yield();
+        pixels[i] = slot - 1;
+    }
+
+    return count;
+}
+
+// Whether this thread gets to calculate pixel
+static bool claim(SharedBorderTrace& st, const unsigned int pixel) {
+    if(st.state[pixel].load(std::memory_order_relaxed) & CLAIMED)
+        return false;
+    return !(st.state[pixel].fetch_or(CLAIMED, std::memory_order_relaxed) & CLAIMED);
+}
+
+// Waits for the thread that claimed pixel; it is calculating it, without waiting for anything itself
+static uint32_t value(const SharedBorderTrace& st, const unsigned int pixel) {
+    while(!(st.state[pixel].load(std::memory_order_acquire) & COLORED))
+        std::this_thread::yield();
+
+    return st.pixels[pixel];
+}
+
+
+void Fractal::sharedBorderTrace(SharedBorderTrace& st) const {
+    double cr[BATCHSIZE], ci[BATCHSIZE];
+    uint32_t colors[BATCHSIZE];
+    unsigned int index[BATCHSIZE];
+    unsigned int frontier[FRONTIERPIXELS];
+    unsigned int queued[FRONTIERPIXELS * 8];
+
+    while(!isCancelled(st.options->cancel)) {
+        const unsigned int frontierSize = pop(st, frontier, FRONTIERPIXELS);
+
+        if(frontierSize == 0) {
+            if(st.pending == 0)
+                return;
+
+            // Others are still checking pixels, which can queue more
+            st.idle++;
+            {
+                std::unique_lock<std::mutex> lock(st.idleMutex);
+                st.work.wait(lock, [&]() { return st.pending == 0 || st.head < st.tail || isCancelled(st.options->cancel); });
+            }
+            st.idle--;
+            continue;
+        }
+
+        // Claim the pixels of the frontier and their neighbors that nobody has claimed yet, and calculate them as one batch
+        unsigned int count = 0;
+        for(unsigned int f = 0; f < frontierSize; f++) {
+            const unsigned int x = frontier[f] % st.w,
+                               y = frontier[f] / st.w;
+
+            for(int i = -1; i < 8; i++) {  // -1 is the pixel itself
+                const unsigned int nX = x + (i < 0 ? 0 : NEIGHBORX[i]),
+                                   nY = y + (i < 0 ? 0 : NEIGHBORY[i]);  // Wraps around past 0, so it fails the checks below
+                if(nX < st.r.xMin || nX >= st.r.xMax || nY < st.r.yMin || nY >= st.r.yMax)
+                    continue;
+
+                const unsigned int pixel = nY * st.w + nX;
+                if(claim(st, pixel)) {
+                    cr[count] = st.rMin + (nX * st.pixelSize);
+                    ci[count] = st.iMax - (nY * st.pixelSize);
+                    index[count++] = pixel;
+                }
+            }
+        }
+
+        if(count > 0) {
+            calcPixels(cr, ci, count, st.pixelSize, *st.options, colors);
+            for(unsigned int j = 0; j < count; j++) {
+                st.pixels[index[j]] = colors[j];
+                st.state[index[j]].fetch_or(COLORED, std::memory_order_release);
+            }
+        }
+
+        // Queue the neighbors that are different
+        unsigned int queuedSize = 0;
+        for(unsigned int f = 0; f < frontierSize; f++) {
+            const unsigned int x = frontier[f] % st.w,
+                               y = frontier[f] / st.w;
+            const uint32_t pixelColor = value(st, frontier[f]);
+
+            for(unsigned int i = 0; i < 8; i++) {
+                const unsigned int nX = x + NEIGHBORX[i],
+                                   nY = y + NEIGHBORY[i];
+                if(nX < st.r.xMin || nX >= st.r.xMax || nY < st.r.yMin || nY >= st.r.yMax)
+                    continue;
+
+                const unsigned int pixel = nY * st.w + nX;
+                if(value(st, pixel) != pixelColor && markQueued(st, pixel))
+                    queued[queuedSize++] = pixel;
+            }
+        }
+
+        push(st, queued, queuedSize);
+        if((st.pending -= frontierSize) == 0)
+            notifyIdle(st);
+    }
+
+    // Cancelled; the others may be waiting for pixels that won't be queued anymore
+    notifyIdle(st);
+}
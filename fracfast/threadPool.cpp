@@ -0,0 +1,120 @@
+#include "threadPool.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+ThreadPool::ThreadPool(const unsigned int threads, const bool pin) : defaultSize(threads), pinned(pin), job(nullptr), generation(0), active(0), remaining(0), stopping(false) {
+    start(threads);
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+
+unsigned int ThreadPool::size() const {
+    return defaultSize;
+}
+
+
+void ThreadPool::configure(const unsigned int threads, const bool pin) {
+    std::lock_guard<std::mutex> guard(runMutex);
+
+    stop();
+    defaultSize = (threads == 0 ? 1 : threads);
+    pinned = pin;
+    start(defaultSize);
+}
+
+
+void ThreadPool::run(const unsigned int workers, const PoolJob& j) {
+    std::lock_guard<std::mutex> guard(runMutex);
+    runJob(workers, j);
+}
+
+bool ThreadPool::tryRun(const unsigned int workers, const PoolJob& j) {
+    std::unique_lock<std::mutex> guard(runMutex, std::try_to_lock);
+    if(!guard.owns_lock())
+        return false;
+
+    runJob(workers, j);
+    return true;
+}
+
+void ThreadPool::runJob(const unsigned int workers, const PoolJob& j) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if(workers > threads.size())
+        start(workers);
+
+    job = &j;
+    active = remaining = workers;
+    generation++;
+    wake.notify_all();
+
+    done.wait(lock, [this]() { return remaining == 0; });
+    job = nullptr;
+}
+
+
+// Adds threads until there are count; called with mutex held or before any run
+void ThreadPool::start(const unsigned int count) {
+    const unsigned int cores = std::thread::hardware_concurrency();
+
+    for(unsigned int i = threads.size(); i < count; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i, generation);
+
+#ifdef __linux__
+        if(pinned && cores > 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % cores, &set);
+            pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpu_set_t), &set);
+        }
+#endif
+    }
+}
+
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for(auto& t : threads)
+        t.join();
+    threads.clear();
+
+    stopping = false;
+}
+
+
+void ThreadPool::workerLoop(const unsigned int index, unsigned long seen) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        wake.wait(lock, [&]() { return stopping || generation != seen; });
+        if(stopping)
+            return;
+
+        seen = generation;
+        if(index >= active)
+            continue;
+
+        const PoolJob& j = *job;
+        lock.unlock();
+        j(index);
+        lock.lock();
+
+        if(--remaining == 0)
+            done.notify_all();
+    }
+}
+
+
+ThreadPool& threadPool() {
+    static ThreadPool pool(std::thread::hardware_concurrency() == 0 ? 8 : std::thread::hardware_concurrency(), false);
+    return pool;
+}
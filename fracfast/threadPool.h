@@ -0,0 +1,65 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Run by every worker taking part in ThreadPool::run; worker is 0 up to the number of workers asked for
+typedef std::function<void(const unsigned int worker)> PoolJob;
+
+
+// Long-lived worker threads, reused by every render of every window instead of starting threads for each frame
+class ThreadPool {
+    public:
+        ThreadPool(const unsigned int threads, const bool pin);
+        ~ThreadPool();
+
+        // Number of workers used when a render doesn't ask for a specific number
+        unsigned int size() const;
+
+        // Restarts the pool with this many threads; with pin, worker i only runs on core i % cores
+        // Not thread safe with run
+        void configure(const unsigned int threads, const bool pin);
+
+        // Runs job on the first workers threads and returns when they are all done; the pool grows if it's too small
+        // One job runs at a time, other callers wait for it to finish
+        void run(const unsigned int workers, const PoolJob& job);
+        // Same, but returns false right away without running job if another job is running, so the caller can do it itself
+        // For short jobs like coloring, which shouldn't wait minutes for a deep render of another window
+        bool tryRun(const unsigned int workers, const PoolJob& job);
+
+
+    private:
+        std::vector<std::thread> threads;
+        unsigned int defaultSize;
+        bool pinned;
+
+        std::mutex runMutex;  // Held for a whole run
+
+        // Guard everything below
+        std::mutex mutex;
+        std::condition_variable wake, done;
+        const PoolJob* job;
+        unsigned long generation;  // Incremented for every run, so workers know there's a new job
+        unsigned int active;       // Workers taking part in the current job
+        unsigned int remaining;    // Workers that haven't finished the current job
+        bool stopping;
+
+        // Called with runMutex held
+        void runJob(const unsigned int workers, const PoolJob& job);
+        void start(const unsigned int count);
+        void stop();
+        void workerLoop(const unsigned int index, unsigned long seen);
+};
+
+
+// The pool of the fracfast library, created on first use with a thread per core
+ThreadPool& threadPool();
+
+
+#endif  // THREAD_POOL_H
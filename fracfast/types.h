@@ -5,9 +5,32 @@
 
 #include <gmp.h>
 
-
-// TODO: Add compiler flag to set this
-typedef unsigned int iter_t;
+#include <atomic>
+#include <cmath>
+#include <climits>
+#include <cstdint>
+#include <limits>
+
+
+// Width of iteration counts, and of the buffers of them the kernels fill, in bits; set with ITERBITS in the Makefiles
+// 16 bits for shallow renders halves the memory traffic of those buffers, 64 bits for deep zooms with nMax above 4 billion
+// The library and the program using it have to be built with the same width
+#ifndef ITERBITS
+#define ITERBITS 32
+#endif
+
+#if ITERBITS == 16
+typedef uint16_t iter_t;
+#elif ITERBITS == 32
+typedef uint32_t iter_t;
+#elif ITERBITS == 64
+typedef uint64_t iter_t;
+#else
+#error "ITERBITS has to be 16, 32 or 64"
+#endif
+
+// Highest nMax iter_t can hold
+const iter_t MAXITERATIONS = std::numeric_limits<iter_t>::max();
 
 
 struct Domain {
@@ -21,6 +44,164 @@ struct HighPrecDomain {
 };
 
 
+// Double mantissa with a separate exponent: value = m * 2^e
+// For perturbation differences smaller than a double can hold (beyond about 1e-308)
+struct FloatExp {
+    static const long ZERO = LONG_MIN / 4;  // Exponent of 0, so it's the smallest when aligning
+
+    double m;  // 0.5 <= |m| < 1, or 0
+    long e;
+
+    FloatExp() : m(0), e(ZERO) {}
+    FloatExp(const double d) : m(d), e(0) { normalize(); }
+    FloatExp(const double mantissa, const long exponent) : m(mantissa), e(exponent) { normalize(); }
+    explicit FloatExp(const mpf_t f) : e(0) { m = mpf_get_d_2exp(&e, f); normalize(); }
+
+    // 0 or infinity if out of range
+    double toDouble() const {
+        if(e < -1100)
+            return m * 0.0;
+        if(e > 1100)
+            return m * HUGE_VAL;
+        return ldexp(m, e);
+    }
+
+    void normalize() {
+        int exp;
+        m = frexp(m, &exp);
+        e = (std::fpclassify(m) == FP_ZERO ? ZERO : e + exp);
+    }
+};
+
+inline FloatExp operator*(const FloatExp& a, const FloatExp& b) {
+    return FloatExp(a.m * b.m, a.e + b.e);
+}
+
+inline FloatExp operator/(const FloatExp& a, const FloatExp& b) {
+    return FloatExp(a.m / b.m, a.e - b.e);
+}
+
+// The smaller operand is aligned to the larger; beyond 64 bits difference it doesn't change the mantissa anyway
+inline FloatExp operator+(const FloatExp& a, const FloatExp& b) {
+    if(a.e >= b.e)
+        return (a.e - b.e > 64 ? a : FloatExp(a.m + ldexp(b.m, b.e - a.e), a.e));
+    else
+        return (b.e - a.e > 64 ? b : FloatExp(ldexp(a.m, a.e - b.e) + b.m, b.e));
+}
+
+inline FloatExp operator-(const FloatExp& a) {
+    FloatExp n = a;
+    n.m = -n.m;
+    return n;
+}
+
+inline FloatExp operator-(const FloatExp& a, const FloatExp& b) {
+    return a + (-b);
+}
+
+inline bool operator<(const FloatExp& a, const FloatExp& b)  { return (a - b).m < 0; }
+inline bool operator>(const FloatExp& a, const FloatExp& b)  { return (a - b).m > 0; }
+inline bool operator<=(const FloatExp& a, const FloatExp& b) { return !(a > b); }
+inline bool operator>=(const FloatExp& a, const FloatExp& b) { return !(a < b); }
+
+inline FloatExp sqrt(const FloatExp& a) {
+    // Make the exponent even
+    return (a.e % 2 == 0 ? FloatExp(sqrt(a.m), a.e / 2) : FloatExp(sqrt(a.m * 2.0), (a.e - 1) / 2));
+}
+
+inline FloatExp hypot(const FloatExp& a, const FloatExp& b) {
+    return sqrt((a * a) + (b * b));
+}
+
+
+// Unevaluated sum of two doubles: value = hi + lo with |lo| <= ulp(hi) / 2, which gives about 106 bits of mantissa
+// For zooms between where doubles run out (about 1e-15) and about 1e-30, at a fraction of the cost of GMP
+// The error-free transforms below rely on exact IEEE rounding, so don't compile this with -ffast-math
+struct DoubleDouble {
+    double hi, lo;
+
+    DoubleDouble() : hi(0), lo(0) {}
+    DoubleDouble(const double d) : hi(d), lo(0) {}
+    DoubleDouble(const double h, const double l) : hi(h), lo(l) {}
+    // Rounds f to the nearest double-double
+    explicit DoubleDouble(const mpf_t f) {
+        mpf_t rest;
+        mpf_init2(rest, mpf_get_prec(f));
+        hi = mpf_get_d(f);
+        mpf_set_d(rest, hi);
+        mpf_sub(rest, f, rest);
+        lo = mpf_get_d(rest);
+        mpf_clear(rest);
+    }
+
+    double toDouble() const {
+        return hi + lo;
+    }
+
+    // a + b = s + e exactly, if |a| >= |b|
+    static inline DoubleDouble quickTwoSum(const double a, const double b) {
+        const double s = a + b;
+        return DoubleDouble(s, b - (s - a));
+    }
+
+    // a + b = s + e exactly
+    static inline DoubleDouble twoSum(const double a, const double b) {
+        const double s = a + b,
+                     bb = s - a;
+        return DoubleDouble(s, (a - (s - bb)) + (b - bb));
+    }
+
+    // a * b = p + e exactly
+    static inline DoubleDouble twoProd(const double a, const double b) {
+        const double p = a * b;
+#ifdef __FMA__
+        return DoubleDouble(p, fma(a, b, -p));
+#else
+        // Dekker's product: split both in 26 bit halves, so the partial products are exact
+        const double split = 134217729.0;  // 2^27 + 1
+        double t = split * a;
+        const double ah = t - (t - a), al = a - ah;
+        t = split * b;
+        const double bh = t - (t - b), bl = b - bh;
+        return DoubleDouble(p, ((ah * bh - p) + ah * bl + al * bh) + al * bl);
+#endif
+    }
+};
+
+inline DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b) {
+    DoubleDouble s = DoubleDouble::twoSum(a.hi, b.hi);
+    const DoubleDouble t = DoubleDouble::twoSum(a.lo, b.lo);
+    s.lo += t.hi;
+    s = DoubleDouble::quickTwoSum(s.hi, s.lo);
+    s.lo += t.lo;
+    return DoubleDouble::quickTwoSum(s.hi, s.lo);
+}
+
+inline DoubleDouble operator-(const DoubleDouble& a) {
+    return DoubleDouble(-a.hi, -a.lo);
+}
+
+inline DoubleDouble operator-(const DoubleDouble& a, const DoubleDouble& b) {
+    return a + (-b);
+}
+
+inline DoubleDouble operator*(const DoubleDouble& a, const DoubleDouble& b) {
+    DoubleDouble p = DoubleDouble::twoProd(a.hi, b.hi);
+    p.lo += (a.hi * b.lo) + (a.lo * b.hi);
+    return DoubleDouble::quickTwoSum(p.hi, p.lo);
+}
+
+inline DoubleDouble operator*(const DoubleDouble& a, const double b) {
+    DoubleDouble p = DoubleDouble::twoProd(a.hi, b);
+    p.lo += a.lo * b;
+    return DoubleDouble::quickTwoSum(p.hi, p.lo);
+}
+
+inline DoubleDouble operator*(const double a, const DoubleDouble& b) {
+    return b * a;
+}
+
+
 struct Resolution {
     unsigned int w;
     unsigned int h;
@@ -39,4 +220,34 @@ struct Selection {
 };
 
 
+// Set from another thread to stop a render early; renders check it between tiles and rows and leave the pixels they didn't get to as they are
+struct CancelToken {
+    std::atomic<bool> cancelled;
+
+    CancelToken() : cancelled(false) {}
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    void reset()  { cancelled.store(false, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+};
+
+// Renders take a null token when they can't be cancelled
+inline bool isCancelled(const CancelToken* cancel) {
+    return cancel != nullptr && cancel->isCancelled();
+}
+
+
+// Summed over all threads of a render. A copy starts at 0, so objects that are copied for every frame can have one
+struct Counter {
+    std::atomic<unsigned long> count;
+
+    Counter() : count(0) {}
+    Counter(const Counter&) : count(0) {}
+
+    void add(const unsigned long n) { count.fetch_add(n, std::memory_order_relaxed); }
+    // Returns the count and starts over
+    unsigned long take() { return count.exchange(0, std::memory_order_relaxed); }
+};
+
+
 #endif  // TYPES_H
\ No newline at end of file
@@ -7,6 +7,13 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstdint>
+#include <cstring>
+
+
+// Bits lost to rounding errors while iterating, on top of the bits needed to tell neighbouring pixels apart
+static const long GUARDBITS = 10;
+static const long DOUBLEBITS = 53;
+static const long DOUBLEDOUBLEBITS = 106;
 
 
 void complexToXY(Point& c, const Domain& dom, const Resolution& res, int& x, int& y) {
@@ -17,14 +24,74 @@ void complexToXY(Point& c, const Domain& dom, const Resolution& res, int& x, int
 }
 
 
+// Copies the from rectangle of src to the to rectangle of dst, which are the same size; src and dst are srcW and dstW pixels wide
+static void copyRect(const uint32_t* const src, const unsigned int srcW, const SDL_Rect& from, uint32_t* const dst, const unsigned int dstW, const SDL_Rect& to) {
+    for(int y = 0; y < from.h; y++)
+        memcpy(dst + ((to.y + y) * dstW) + to.x, src + ((from.y + y) * srcW) + from.x, from.w * sizeof(uint32_t));
+}
+
+// Copies the rows of from upside down to the rows of to, for symmetry; rows outside the screen are skipped
+static void mirrorRows(uint32_t* const pixels, const Resolution& res, const SDL_Rect& from, const SDL_Rect& to) {
+    for(int i = 0; i < to.h; i++) {
+        const int src = from.y + from.h - 1 - i,
+                  dst = to.y + i;
+        if(src >= 0 && src < (int)res.h && dst >= 0 && dst < (int)res.h)
+            memcpy(pixels + (dst * res.w), pixels + (src * res.w), res.w * sizeof(uint32_t));
+    }
+}
+
+
+PrecisionPlan planPrecision(const HighPrecDomain& domain, const Resolution& res) {
+    mpf_t ps;
+    mpf_init2(ps, mpf_get_prec(domain.rMin));
+    mpf_sub(ps, domain.rMax, domain.rMin);
+    mpf_div_ui(ps, ps, res.w);
+    long psExp;
+    mpf_get_d_2exp(&psExp, ps);
+    mpf_clear(ps);
+
+    // Orbits get up to |z| = 2 before escaping, so the magnitude is at least that of 2
+    long magExp = 2, e;
+    const mpf_t* const bounds[4] = {&domain.rMin, &domain.rMax, &domain.iMin, &domain.iMax};
+    for(auto b : bounds) {
+        mpf_get_d_2exp(&e, *b);
+        if(mpf_sgn(*b) != 0 && e > magExp)
+            magExp = e;
+    }
+
+    const long bits = magExp - psExp + GUARDBITS;
+
+    PrecisionPlan plan;
+    plan.bits = ((bits + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS) * GMP_NUMB_BITS;
+    if(bits <= DOUBLEBITS)
+        plan.tier = Precision::Double;
+    else if(bits <= DOUBLEDOUBLEBITS)
+        plan.tier = Precision::DoubleDouble;
+    else
+        plan.tier = Precision::GMP;
+
+    return plan;
+}
+
+
 Graphics::Graphics() {
+    screen = NULL;
+    symmetry = true;
     coloring = Coloring::escapeTime;
+    palette = Palette::Polynomial;
+    lineDetail = 5000;
+    redrawForced = false;
+    unchanged = false;
+    frame = nullptr;
 
     mpf_inits(newDomain.rMin, newDomain.rMax, newDomain.iMin, newDomain.iMax, pixelSize, NULL);
 }
 
 Graphics::~Graphics() {
-    prev.destroy();
+    if(screen != NULL)
+        SDL_DestroyTexture(screen);
+    if(frame != nullptr)
+        delete[] frame;
 
     SDL_DestroyRenderer(renderer);
 
@@ -50,9 +117,9 @@ void Graphics::initRenderer(SDL_Window* const window) {
 
 
 void Graphics::drawClick(const int x, const int y) {
-    if(prev.pixels == NULL)
+    if(screen == NULL)
         return;
-    SDL_RenderCopy(renderer, prev.pixels, NULL, NULL);
+    SDL_RenderCopy(renderer, screen, NULL, NULL);
 
     SDL_SetRenderDrawColor(renderer, 0xff, 0x00, 0x00, 0xff);
     SDL_Rect rect = {x - 3, y - 3, 7, 7};
@@ -72,9 +139,9 @@ void Graphics::drawClick(const int x, const int y) {
 
 // TODO: Max N orbits
 void Graphics::drawOrbit(const Fractal* const fractal, const double c[2], const Domain& domain, const Resolution& res) {
-    if(prev.pixels == NULL)
+    if(screen == NULL)
         return;
-    SDL_RenderCopy(renderer, prev.pixels, NULL, NULL);
+    SDL_RenderCopy(renderer, screen, NULL, NULL);
     SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0xff);
 
     Orbit points;
@@ -99,9 +166,29 @@ void Graphics::setSymmetry(const bool sym) {
 }
 
 
-void Graphics::setLineDetail(Fractal* const fractal, const double lineDetail) {
-    forceRedraw();
-    fractal->setLineDetail(lineDetail);
+void Graphics::setPrecision(const mp_bitcnt_t bits) {
+    if(mpf_get_prec(pixelSize) >= bits)
+        return;
+
+    // mpf_set_prec keeps the values, only rounded to the new precision
+    mpf_set_prec(newDomain.rMin, bits); mpf_set_prec(newDomain.rMax, bits); mpf_set_prec(newDomain.iMin, bits); mpf_set_prec(newDomain.iMax, bits);
+    mpf_set_prec(prev.domain.rMin, bits); mpf_set_prec(prev.domain.rMax, bits); mpf_set_prec(prev.domain.iMin, bits); mpf_set_prec(prev.domain.iMax, bits);
+    mpf_set_prec(other.domain.rMin, bits); mpf_set_prec(other.domain.rMax, bits); mpf_set_prec(other.domain.iMin, bits); mpf_set_prec(other.domain.iMax, bits);
+    mpf_set_prec(pixelSize, bits);
+}
+
+void Graphics::cancel() {
+    cancelToken.cancel();
+}
+
+void Graphics::resetCancel() {
+    cancelToken.reset();
+    unchanged = false;
+}
+
+
+void Graphics::setLineDetail(const double d) {
+    lineDetail = d;
 }
 
 
@@ -112,6 +199,14 @@ void Graphics::nextColoring() {
     }
 }
 
+void Graphics::nextPalette() {
+    switch(palette) {
+        case Palette::Polynomial:   palette = Palette::Cyclic;          break;
+        case Palette::Cyclic:       palette = Palette::BlackWhite;      break;
+        case Palette::BlackWhite:   palette = Palette::Polynomial;      break;
+    }
+}
+
 
 void Graphics::setScreen() {
     SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xff);
@@ -123,24 +218,47 @@ void Graphics::blit() {
 }
 
 
-void Graphics::draw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res) {
-    SDL_Texture* texture = calculatePixels(fractal, domain, res);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
+void Graphics::draw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown) {
+    // Something else than the coloring may have changed, so the frame kept for the other coloring is out of date
+    other.forceRedraw();
+    drawFrame(fractal, domain, res, passShown);
+}
+
+void Graphics::drawFrame(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown) {
+    redrawForced = false;
+    const Coloring c = coloring;
 
-    // This deletes will delete the texture created in this function
-    prev.update(domain, texture);
+    uint32_t* pixels = calculatePixels(fractal, domain, res, passShown);
+    if(pixels == nullptr) {  // Cancelled before the first pass finished, so the last frame stays on screen
+        unchanged = true;
+        return;
+    }
+
+    // This deletes the pixels of the previous frame
+    prev.update(domain, pixels, res, c, fractal->getnMax());
+    prev.partial = cancelToken.isCancelled();
+
+    // Counted over all passes of a progressive render
+    const unsigned long periodic = fractal->takePeriodicCount();
+    if(periodic > 0 && !prev.partial)
+        std::cout << "\rPeriodicity checking stopped early at " << periodic << " points in the set" << std::endl
+                  << "$ " << std::flush;
 }
 
 // TODO: Use range to simplify this function
 void Graphics::extendDraw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res) {
     // TODO: Fix extendDraw for exterior distance estimation
-    if(prev.pixels == NULL || coloring == Coloring::distance) {
+    // Requests that came in while rendering are merged, so the last frame may be moved in both directions
+    if(prev.pixels == nullptr || prev.partial || redrawForced || coloring == Coloring::distance
+       || prev.coloring != coloring || prev.nMax != fractal->getnMax()
+       || prev.res.w != res.w || prev.res.h != res.h
+       || (mpf_cmp(domain.rMin, prev.domain.rMin) != 0 && mpf_cmp(domain.iMin, prev.domain.iMin) != 0)) {
         draw(fractal, domain, res);
         return;
     }
 
     SDL_Rect reusePixelsSrc, reusePixelsDst, newPixelsDst;
-    SDL_Texture* newPixels;
+    uint32_t* newPixels;
     if(mpf_cmp(domain.rMin, prev.domain.rMin) < 0) {  // Left
         //pixelSize = (rMax - rMin) / res.w;
         mpf_sub(pixelSize, domain.rMax, domain.rMin);
@@ -150,6 +268,10 @@ void Graphics::extendDraw(const Fractal* const fractal, const HighPrecDomain& do
         mpf_sub(newDomain.rMin, prev.domain.rMin, domain.rMin);  // Use newDomain.rMin as temp
         mpf_div(newDomain.rMin, newDomain.rMin, pixelSize);
         const unsigned int pixelsMoved = mpf_get_d(newDomain.rMin);
+        if(pixelsMoved == 0 || pixelsMoved >= res.w) {
+            draw(fractal, domain, res);
+            return;
+        }
         
         reusePixelsSrc = {0, 0, (int)res.w - (int)pixelsMoved, (int)res.h};
         reusePixelsDst = {(int)pixelsMoved, 0, (int)res.w - (int)pixelsMoved, (int)res.h};
@@ -172,6 +294,10 @@ void Graphics::extendDraw(const Fractal* const fractal, const HighPrecDomain& do
         mpf_sub(newDomain.rMin, domain.rMin, prev.domain.rMin);  // Use newDomain.rMin as temp
         mpf_div(newDomain.rMin, newDomain.rMin, pixelSize);
         const unsigned int pixelsMoved = mpf_get_d(newDomain.rMin);
+        if(pixelsMoved == 0 || pixelsMoved >= res.w) {
+            draw(fractal, domain, res);
+            return;
+        }
 
         reusePixelsSrc = {(int)pixelsMoved, 0, (int)res.w - (int)pixelsMoved, (int)res.h};
         reusePixelsDst = {0, 0, (int)res.w - (int)pixelsMoved, (int)res.h};
@@ -195,6 +321,10 @@ void Graphics::extendDraw(const Fractal* const fractal, const HighPrecDomain& do
         mpf_sub(newDomain.rMin, domain.iMin, prev.domain.iMin);  // Use newDomain.rMin as temp
         mpf_div(newDomain.rMin, newDomain.rMin, pixelSize);
         const unsigned int pixelsMoved = mpf_get_d(newDomain.rMin);
+        if(pixelsMoved == 0 || pixelsMoved >= res.h) {
+            draw(fractal, domain, res);
+            return;
+        }
         
         reusePixelsSrc = {0, 0, (int)res.w, (int)res.h - (int)pixelsMoved};
         reusePixelsDst = {0, (int)pixelsMoved, (int)res.w, (int)res.h - (int)pixelsMoved};
@@ -217,6 +347,10 @@ void Graphics::extendDraw(const Fractal* const fractal, const HighPrecDomain& do
         mpf_sub(newDomain.rMin, prev.domain.iMin, domain.iMin);  // Use newDomain.rMin as temp
         mpf_div(newDomain.rMin, newDomain.rMin, pixelSize);
         const unsigned int pixelsMoved = mpf_get_d(newDomain.rMin);
+        if(pixelsMoved == 0 || pixelsMoved >= res.h) {
+            draw(fractal, domain, res);
+            return;
+        }
 
         reusePixelsSrc = {0, (int)pixelsMoved, (int)res.w, (int)res.h - (int)pixelsMoved};
         reusePixelsDst = {0, 0, (int)res.w, (int)res.h - (int)pixelsMoved};
@@ -237,32 +371,104 @@ void Graphics::extendDraw(const Fractal* const fractal, const HighPrecDomain& do
         return;
     }
 
-    // Make a new texture to render the screen to and set renderer to this texture
-    SDL_Texture* const screen = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, res.h);
-    SDL_SetRenderTarget(renderer, screen);
-    SDL_RenderCopy(renderer, prev.pixels, &reusePixelsSrc, &reusePixelsDst);
+    // Put the recycled pixels and the new ones together in a new frame
+    uint32_t* const pixels = new uint32_t[res.w * res.h];
+    copyRect(prev.pixels, res.w, reusePixelsSrc, pixels, res.w, reusePixelsDst);
+    copyRect(newPixels, newPixelsDst.w, {0, 0, newPixelsDst.w, newPixelsDst.h}, pixels, res.w, newPixelsDst);
 
-    // SDL_SetRenderDrawColor(renderer, 0, 255, 255, 255);
-    // SDL_RenderFillRect(renderer, &newPixelsDst);
-    SDL_RenderCopy(renderer, newPixels, NULL, &newPixelsDst);
-    SDL_SetRenderTarget(renderer, NULL);
+    delete[] newPixels;
 
-    SDL_DestroyTexture(newPixels);
+    prev.update(domain, pixels, res, prev.coloring, prev.nMax);
+    prev.partial = cancelToken.isCancelled();
+}
 
-    // Render texture to screen
+// Publish colors the frame, so there's nothing to do when it's of this view
+void Graphics::recolorDraw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown) {
+    const iter_t nMax = fractal->getnMax();
+    if(!redrawForced && !prev.matches(domain, res, coloring, nMax) && other.matches(domain, res, coloring, nMax))
+        prev.swap(other);
+    if(!redrawForced && prev.matches(domain, res, coloring, nMax))
+        return;
+
+    // Only the coloring changed, so this frame is kept for when it's changed back
+    if(!redrawForced && prev.matches(domain, res, prev.coloring, nMax)) {
+        prev.swap(other);
+        drawFrame(fractal, domain, res, passShown);
+    }
+    else
+        draw(fractal, domain, res, passShown);
+}
+
+// Present may skip frames, when the render thread finishes them faster than they are shown
+void Graphics::publish() {
+    if(prev.pixels == nullptr || unchanged)
+        return;
+
+    publishFrame(colorFrame(prev.pixels, prev.res, prev.coloring, prev.nMax), prev.res);
+}
+
+uint32_t* Graphics::colorFrame(const uint32_t* const values, const Resolution& res, const Coloring c, const iter_t nMax) const {
+    uint32_t* const pixels = new uint32_t[res.w * res.h];
+    switch(c) {
+        case Coloring::escapeTime:  colorIterations(values, pixels, res.w * res.h, nMax, palette);  break;
+        case Coloring::distance:    colorDistances(values, pixels, res.w * res.h, lineDetail);      break;
+    }
+
+    return pixels;
+}
+
+void Graphics::publishFrame(uint32_t* const pixels, const Resolution& res) {
+    std::lock_guard<std::mutex> guard(frameMutex);
+    if(frame != nullptr)
+        delete[] frame;
+    frame = pixels;
+    frameRes = res;
+}
+
+PassFunction Graphics::passPublisher(const Resolution& res, const iter_t nMax, const bool sym, const SDL_Rect& symFrom, const SDL_Rect& symTo, const std::function<void()>& passShown) {
+    return [=](const uint32_t* const shown, const unsigned int) {
+        uint32_t* const copy = colorFrame(shown, res, Coloring::escapeTime, nMax);
+        if(sym)
+            mirrorRows(copy, res, symFrom, symTo);
+
+        publishFrame(copy, res);
+        passShown();
+    };
+}
+
+bool Graphics::present() {
+    uint32_t* pixels;
+    Resolution res;
+    {
+        std::lock_guard<std::mutex> guard(frameMutex);
+        if(frame == nullptr)
+            return false;
+        pixels = frame; res = frameRes;
+        frame = nullptr;
+    }
+
+    int w = 0, h = 0;
+    if(screen != NULL)
+        SDL_QueryTexture(screen, NULL, NULL, &w, &h);
+    if(screen == NULL || w != (int)res.w || h != (int)res.h) {
+        if(screen != NULL)
+            SDL_DestroyTexture(screen);
+        screen = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, res.h);
+    }
+    SDL_UpdateTexture(screen, NULL, pixels, res.w * sizeof(uint32_t));
+    delete[] pixels;
+
+    setScreen();
     SDL_RenderCopy(renderer, screen, NULL, NULL);
 
-    prev.update(domain, screen);
+    return true;
 }
 
 void Graphics::deepenDraw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res) {
-    SDL_Texture* const texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, res.w, res.h);
+    if(prev.pixels == nullptr)
+        return;
     uint32_t* pixels = new uint32_t[res.w * res.h];  //calculatePixels(fractal, domain, res);
-
-    SDL_SetRenderTarget(renderer, prev.pixels);
-
-    // std::clock_t start = std::clock();
-    SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGBA8888, pixels, res.w * sizeof(uint32_t));
+    memcpy(pixels, prev.pixels, res.w * res.h * sizeof(uint32_t));
 
     // fractal->deepenRender(pixels, domain, res);
     for(unsigned int i = 0; i < res.w * res.h; i++) {
@@ -272,27 +478,20 @@ void Graphics::deepenDraw(const Fractal* const fractal, const HighPrecDomain& do
             std::cout << "geen kleur" << std::endl;
     }
 
-    SDL_UpdateTexture(texture, NULL, pixels, res.w * sizeof(uint32_t));
-    SDL_SetRenderTarget(renderer, NULL);
-
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-
-    if(pixels != nullptr)
-        delete[] pixels;
-
-    prev.update(domain, texture);
+    prev.update(domain, pixels, res, prev.coloring, prev.nMax);
+    publish();
 
     return;
 
     // Prevent warning
-    fractal->render({mpf_get_d(domain.rMin), mpf_get_d(domain.rMax), mpf_get_d(domain.iMin), mpf_get_d(domain.iMax)}, res, {0, res.w, 0, res.h}, nullptr);
+    fractal->render({mpf_get_d(domain.rMin), mpf_get_d(domain.rMax), mpf_get_d(domain.iMin), mpf_get_d(domain.iMax)}, res, {0, res.w, 0, res.h}, RenderOptions());
 }
 
 
-SDL_Texture* Graphics::calculatePixels(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res) {
+uint32_t* Graphics::calculatePixels(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown) {
     switch(fractal->fractalType) {
-        case Fractals::Mandelbrot:  return calculateMandelbrot((Mandelbrot*)fractal, domain, res);  break;
-        case Fractals::Julia:       return calculateJulia((Julia*)fractal, domain, res);            break;
+        case Fractals::Mandelbrot:  return calculateMandelbrot((Mandelbrot*)fractal, domain, res, passShown);  break;
+        case Fractals::Julia:       return calculateJulia((Julia*)fractal, domain, res, passShown);            break;
         case Fractals::None:        break;
     }
 
@@ -301,13 +500,17 @@ SDL_Texture* Graphics::calculatePixels(const Fractal* const fractal, const HighP
 }
 
 
-SDL_Texture* Graphics::calculateMandelbrot(const Mandelbrot* const fractal, const HighPrecDomain& domain, const Resolution& res) const {
-    SDL_Texture* const texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, res.h);
-    ShapeVector shapes = {inCardioid, in2Bulb};  // TODO: Only add shape if in screen
+uint32_t* Graphics::calculateMandelbrot(const Mandelbrot* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown) {
     Domain lpDom = {mpf_get_d(domain.rMin), mpf_get_d(domain.rMax), mpf_get_d(domain.iMin), mpf_get_d(domain.iMax)};
+    const PrecisionPlan plan = planPrecision(domain, res);
+
+    // Only the shapes in screen; calcScreen culls them again for every tile
+    RenderOptions options(cullShapes(ALLSHAPES, lpDom), &cancelToken);
+    PerturbationStats stats;
+    options.coloring = coloring; options.precision = plan.tier; options.stats = &stats;
 
     // Symmetry checking
-    SDL_Rect symFrom, symTo;
+    SDL_Rect symFrom = {}, symTo = {};
     unsigned int yMin = 0;
     unsigned int yMax = res.h;
     bool sym = lpDom.iMin < 0 && lpDom.iMax > 0 && symmetry;
@@ -329,37 +532,41 @@ SDL_Texture* Graphics::calculateMandelbrot(const Mandelbrot* const fractal, cons
     const Range r = {0, res.w, yMin, yMax};
     // std::cout << r.yMin << ' ' << r.yMax << std::endl;
     uint32_t* pixels = nullptr;
-    if(coloring == Coloring::escapeTime)
-        // pixels = fractal->render(lpDom, res, r, (void*)&shapes);
-        // ((Mandelbrot*)fractal)->calcScreenGMP(domain, res, r, nullptr, pixels);
-        pixels = fractal->threadedRender(lpDom, res, r, (void*)&shapes);
-        // fractal->calcScreen(lpDom, res, r, (void*)&shapes, pixels);
-        // pixels = fractal->calcScreen(lpDom, res, r, (void*)&shapes);
-    else if(coloring == Coloring::distance) {
+    if(options.coloring == Coloring::escapeTime && options.precision == Precision::GMP) {
         pixels = new uint32_t[res.w * res.h]; memset(pixels, 0x0, res.w * res.h * sizeof(uint32_t));
-        fractal->calcScreenDistance(lpDom, res, r, (void*)&shapes, pixels);
-        // pixels = fractal->threadedRenderBruteforce(lpDom, res, r, (void*)&shapes);
-        // fractal->calcScreenBruteforce(lpDom, res, r, (void*)&shapes, pixels);
-    }
-        // ((Mandelbrot*)fractal)->calcScreenGMPBruteforce(domain, res, r, nullptr, pixels);
-        // pixels = fractal->calcScreen(lpDom, res, r, (void*)&shapes);
-        // pixels = fractal->calcScreen(lpDom, res, r, (void*)&shapes);
-
-    if(sym) {
-        SDL_Texture* const tempTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, yMax - yMin);
-        SDL_UpdateTexture(tempTex, NULL, pixels + (yMin * res.w), res.w * sizeof(uint32_t));
-        SDL_Rect dst = {0, (int)yMin, (int)res.w, (int)(yMax - yMin)};
+        fractal->calcScreenPerturbation(domain, res, r, options, pixels);
 
-        SDL_SetRenderTarget(renderer, texture);
-        SDL_RenderCopy(renderer, tempTex, NULL, &dst);
-        SDL_RenderCopyEx(renderer, texture, &symFrom, &symTo, 0, NULL, SDL_FLIP_VERTICAL);
-        SDL_SetRenderTarget(renderer, NULL);
-
-        SDL_DestroyTexture(tempTex);
+        if(!cancelToken.isCancelled())
+            std::cout << "\rSeries approximation skipped " << stats.skipped << " of " << fractal->getnMax() << " iterations ("
+                      << stats.references << " references, " << stats.glitched << " glitched pixels)" << std::endl
+                      << "$ " << std::flush;
     }
-    else {
-        SDL_UpdateTexture(texture, NULL, pixels, res.w * sizeof(uint32_t));
+    else if(options.coloring == Coloring::escapeTime && options.precision == Precision::DoubleDouble && passShown)
+        pixels = fractal->progressiveRenderDoubleDouble(domain, res, r, options, passPublisher(res, fractal->getnMax(), sym, symFrom, symTo, passShown));
+    else if(options.coloring == Coloring::escapeTime && options.precision == Precision::DoubleDouble)
+        pixels = fractal->threadedRenderDoubleDouble(domain, res, r, options);
+    else if(options.coloring == Coloring::escapeTime && passShown)
+        pixels = fractal->progressiveRender(lpDom, res, r, options, passPublisher(res, fractal->getnMax(), sym, symFrom, symTo, passShown));
+    else if(options.coloring == Coloring::escapeTime)
+        // pixels = fractal->render(lpDom, res, r, options);
+        // ((Mandelbrot*)fractal)->calcScreenGMP(domain, res, r, RenderOptions(), pixels);
+        pixels = fractal->threadedRenderShared(lpDom, res, r, options);
+        // pixels = fractal->threadedRender(lpDom, res, r, options);
+        // fractal->calcScreen(lpDom, res, r, options, pixels);
+        // pixels = fractal->calcScreen(lpDom, res, r, options);
+    else if(options.coloring == Coloring::distance) {  // Distance estimation only exists in double precision
+        pixels = new uint32_t[res.w * res.h]; memset(pixels, 0x0, res.w * res.h * sizeof(uint32_t));
+        fractal->calcScreenDistance(lpDom, res, r, options, pixels);
+        // pixels = fractal->threadedRenderBruteforce(lpDom, res, r, options);
+        // fractal->calcScreenBruteforce(lpDom, res, r, options, pixels);
     }
+        // ((Mandelbrot*)fractal)->calcScreenGMPBruteforce(domain, res, r, RenderOptions(), pixels);
+        // pixels = fractal->calcScreen(lpDom, res, r, options);
+        // pixels = fractal->calcScreen(lpDom, res, r, options);
+
+    // This runs on the render thread, which can't use the renderer, so the other half is mirrored on the CPU
+    if(sym && pixels != nullptr)  // nullptr: a progressive render cancelled before its first pass
+        mirrorRows(pixels, res, symFrom, symTo);
 
     /*  ---Old symmetry copy---  */
     // // Copy to top half
@@ -372,19 +579,16 @@ SDL_Texture* Graphics::calculateMandelbrot(const Mandelbrot* const fractal, cons
 
     // SDL_UpdateTexture(texture, NULL, pixels, res.w * sizeof(uint32_t));
 
-    if(pixels != nullptr)
-        delete[] pixels;
-
-    return texture;
+    return pixels;
 }
 
-SDL_Texture* Graphics::calculateJulia(const Julia* const fractal, const HighPrecDomain& domain, const Resolution& res) {
-    SDL_Texture* const texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, res.h);
-    ShapeVector shapes = {inCardioid, in2Bulb};  // TODO: Only add shape if in screen
+uint32_t* Graphics::calculateJulia(const Julia* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown) {
+    RenderOptions options(NOSHAPES, &cancelToken);  // Shapes are of the Mandelbrot set
+    options.coloring = coloring;
     Domain lpDom = {mpf_get_d(domain.rMin), mpf_get_d(domain.rMax), mpf_get_d(domain.iMin), mpf_get_d(domain.iMax)};
 
     // Symmetry checking
-    SDL_Rect symFrom, symTo;
+    SDL_Rect symFrom = {}, symTo = {};
     unsigned int yMin = 0;
     unsigned int yMax = res.h;
     bool sym = false; //lpDom.iMin < 0 && lpDom.iMax > 0 && lpDom.rMin < 0 && lpDom.rMax > 0 && symmetry;
@@ -406,37 +610,28 @@ SDL_Texture* Graphics::calculateJulia(const Julia* const fractal, const HighPrec
     const Range r = {0, res.w, yMin, yMax};
     // std::cout << r.yMin << ' ' << r.yMax << std::endl;
     uint32_t* pixels = nullptr;
-    if(coloring == Coloring::escapeTime)
-        // pixels = fractal->render(lpDom, res, r, (void*)&shapes);
-        // ((Mandelbrot*)fractal)->calcScreenGMP(domain, res, r, nullptr, pixels);
-        pixels = fractal->threadedRender(lpDom, res, r, (void*)&shapes);
-        // fractal->calcScreen(lpDom, res, r, (void*)&shapes, pixels);
-        // pixels = fractal->calcScreen(lpDom, res, r, (void*)&shapes);
-    else if(coloring == Coloring::distance) {
+    if(options.coloring == Coloring::escapeTime && passShown)
+        pixels = fractal->progressiveRender(lpDom, res, r, options, passPublisher(res, fractal->getnMax(), sym, symFrom, symTo, passShown));
+    else if(options.coloring == Coloring::escapeTime)
+        // pixels = fractal->render(lpDom, res, r, options);
+        // ((Mandelbrot*)fractal)->calcScreenGMP(domain, res, r, RenderOptions(), pixels);
+        pixels = fractal->threadedRenderShared(lpDom, res, r, options);
+        // pixels = fractal->threadedRender(lpDom, res, r, options);
+        // fractal->calcScreen(lpDom, res, r, options, pixels);
+        // pixels = fractal->calcScreen(lpDom, res, r, options);
+    else if(options.coloring == Coloring::distance) {
         pixels = new uint32_t[res.w * res.h]; memset(pixels, 0x0, res.w * res.h * sizeof(uint32_t));
-        fractal->calcScreenDistance(lpDom, res, r, (void*)&shapes, pixels);
-        // pixels = fractal->threadedRenderBruteforce(lpDom, res, r, (void*)&shapes);
-        // fractal->calcScreenBruteforce(lpDom, res, r, (void*)&shapes, pixels);
+        fractal->calcScreenDistance(lpDom, res, r, options, pixels);
+        // pixels = fractal->threadedRenderBruteforce(lpDom, res, r, options);
+        // fractal->calcScreenBruteforce(lpDom, res, r, options, pixels);
     }
-        // ((Mandelbrot*)fractal)->calcScreenGMPBruteforce(domain, res, r, nullptr, pixels);
-        // pixels = fractal->calcScreen(lpDom, res, r, (void*)&shapes);
-        // pixels = fractal->calcScreen(lpDom, res, r, (void*)&shapes);
-
-    if(sym) {
-        SDL_Texture* const tempTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, yMax - yMin);
-        SDL_UpdateTexture(tempTex, NULL, pixels + (yMin * res.w), res.w * sizeof(uint32_t));
-        SDL_Rect dst = {0, (int)yMin, (int)res.w, (int)(yMax - yMin)};
-
-        SDL_SetRenderTarget(renderer, texture);
-        SDL_RenderCopy(renderer, tempTex, NULL, &dst);
-        SDL_RenderCopyEx(renderer, texture, &symFrom, &symTo, 0, NULL, SDL_FLIP_VERTICAL);
-        SDL_SetRenderTarget(renderer, NULL);
+        // ((Mandelbrot*)fractal)->calcScreenGMPBruteforce(domain, res, r, RenderOptions(), pixels);
+        // pixels = fractal->calcScreen(lpDom, res, r, options);
+        // pixels = fractal->calcScreen(lpDom, res, r, options);
 
-        SDL_DestroyTexture(tempTex);
-    }
-    else {
-        SDL_UpdateTexture(texture, NULL, pixels, res.w * sizeof(uint32_t));
-    }
+    // This runs on the render thread, which can't use the renderer, so the other half is mirrored on the CPU
+    if(sym && pixels != nullptr)  // nullptr: a progressive render cancelled before its first pass
+        mirrorRows(pixels, res, symFrom, symTo);
 
     /*  ---Old symmetry copy---  */
     // // Copy to top half
@@ -449,10 +644,7 @@ SDL_Texture* Graphics::calculateJulia(const Julia* const fractal, const HighPrec
 
     // SDL_UpdateTexture(texture, NULL, pixels, res.w * sizeof(uint32_t));
 
-    if(pixels != nullptr)
-        delete[] pixels;
-
-    return texture;
+    return pixels;
     
     // SDL_Texture* const texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, res.h);
 
@@ -477,16 +669,17 @@ SDL_Texture* Graphics::calculateJulia(const Julia* const fractal, const HighPrec
 }
 
 
+// The render thread drops prev at the next extendDraw
 void Graphics::forceRedraw() {
-    prev.forceRedraw();
+    redrawForced = true;
 }
 
 
 void Graphics::refresh() {
-    if(prev.pixels == NULL)
+    if(screen == NULL)
         return;
 
-    SDL_RenderCopy(renderer, prev.pixels, NULL, NULL);
+    SDL_RenderCopy(renderer, screen, NULL, NULL);
     SDL_RenderPresent(renderer);
 }
 
@@ -536,9 +729,9 @@ void dot(int x, int y, SDL_Renderer* renderer) {
 }
 
 void Graphics::select(const Selection* const selection, const Resolution& res) {
-    if(prev.pixels == NULL)
+    if(screen == NULL)
         return;
-    SDL_RenderCopy(renderer, prev.pixels, NULL, NULL);
+    SDL_RenderCopy(renderer, screen, NULL, NULL);
 
     SDL_Rect zoomTo;  // Largest box with same aspect ratio as screen fitting the selection
     SDL_Rect selectionBox;
@@ -8,55 +8,85 @@
 
 #include <SDL2/SDL.h>
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+
 
 // const unsigned int SCALEFRAMES = 30,
 //                    SCALETIME = 1500;  // milliseconds
 
 
-enum class Coloring {
-    escapeTime,
-    distance
+struct PrecisionPlan {
+    Precision tier;
+    mp_bitcnt_t bits;  // Mantissa bits needed to tell neighbouring pixels apart, rounded up to whole limbs
 };
 
+// Picks the cheapest precision that can still tell the pixels of domain apart, by comparing the pixel size to the magnitude of the domain
+PrecisionPlan planPrecision(const HighPrecDomain& domain, const Resolution& res);
+
 
+// Last frame calculated by the render thread, kept to recycle its pixels when translating and to recolor it
+// The pixels are packed iteration counts or distances (fracfast/colorizer.h), depending on coloring
 struct GraphicsState {
     HighPrecDomain domain;
-    SDL_Texture* pixels;
+    uint32_t* pixels;
+    Resolution res;
+    Coloring coloring;
+    iter_t nMax;
+    bool partial;  // The render was cancelled, so pixels can't be recycled
 
 
     GraphicsState() {
-        pixels = NULL;
+        pixels = nullptr;
+        res = {0, 0};
+        coloring = Coloring::escapeTime;
+        nMax = 0;
+        partial = false;
 
         mpf_inits(domain.rMin, domain.rMax, domain.iMin, domain.iMax, NULL);
     }
 
     ~GraphicsState() {
-        if(pixels != NULL)
-            SDL_DestroyTexture(pixels);
+        if(pixels != nullptr)
+            delete[] pixels;
         
         mpf_clears(domain.rMin, domain.rMax, domain.iMin, domain.iMax, NULL);
     }
 
-    void update(const HighPrecDomain& d, SDL_Texture* p) {
-        if(pixels != NULL)
-            SDL_DestroyTexture(pixels);
+    void update(const HighPrecDomain& d, uint32_t* p, const Resolution& r, const Coloring c, const iter_t n) {
+        if(pixels != nullptr)
+            delete[] pixels;
 
         pixels = p;
+        res = r;
+        coloring = c;
+        nMax = n;
 
         mpf_set(domain.rMin, d.rMin); mpf_set(domain.rMax, d.rMax); mpf_set(domain.iMin, d.iMin); mpf_set(domain.iMax, d.iMax);
     }
 
     void forceRedraw() {
-        pixels = NULL;
+        if(pixels != nullptr)
+            delete[] pixels;
+        pixels = nullptr;
     }
 
-    void destroy() {
-        if(pixels != NULL)
-            SDL_DestroyTexture(pixels);
+    void swap(GraphicsState& other) {
+        std::swap(pixels, other.pixels); std::swap(res, other.res); std::swap(coloring, other.coloring); std::swap(nMax, other.nMax); std::swap(partial, other.partial);
+        mpf_swap(domain.rMin, other.domain.rMin); mpf_swap(domain.rMax, other.domain.rMax); mpf_swap(domain.iMin, other.domain.iMin); mpf_swap(domain.iMax, other.domain.iMax);
+    }
+
+    // Holds the values of this frame, so it only needs to be colored again
+    bool matches(const HighPrecDomain& d, const Resolution& r, const Coloring c, const iter_t n) const {
+        return pixels != nullptr && !partial && res.w == r.w && res.h == r.h && coloring == c && nMax == n
+               && mpf_cmp(domain.rMin, d.rMin) == 0 && mpf_cmp(domain.rMax, d.rMax) == 0 && mpf_cmp(domain.iMin, d.iMin) == 0 && mpf_cmp(domain.iMax, d.iMax) == 0;
     }
 };
 
 
+// The fractal is calculated on a render thread into a pixel buffer (draw, extendDraw), which the thread of the window uploads and shows (present)
+// Everything drawing with the SDL renderer must be called from the thread of the window
 class Graphics {
     public:
         Graphics();
@@ -69,9 +99,18 @@ class Graphics {
 
         void setSymmetry(const bool sym);
 
-        void setLineDetail(Fractal* const fractal, const double lineDetail);
-        
+        // Gives the GMP floats kept between frames at least this many bits; render thread only
+        void setPrecision(const mp_bitcnt_t bits);
+
+        // Stops the current render, keeping what is done on screen; can be called from any thread
+        void cancel();
+        // Called by the render thread when it takes a new request, before anything can cancel that one
+        void resetCancel();
+
+        // Only change how the frame is colored; the render thread recolors it with recolorDraw
+        void setLineDetail(const double lineDetail);
         void nextColoring();
+        void nextPalette();
 
         // Sets the screen up for new frame
         void setScreen();
@@ -79,14 +118,22 @@ class Graphics {
         // Updates screen; finish frame
         void blit();
 
-        void draw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res);
+        // Render thread: calculate a frame, then publish hands it to present
+        // With passShown, the frame is rendered progressively and every coarse pass is published before passShown is called
+        void draw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown = nullptr);
         void extendDraw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res);
+        // Colors the last frame again, if it (or the frame before it, in the other coloring) is of this view; draws it otherwise
+        void recolorDraw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown = nullptr);
         void deepenDraw(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res);
+        void publish();
 
-        SDL_Texture* calculatePixels(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res);
+        // Copies the newest finished frame to the screen, without blitting; false if there is none
+        bool present();
 
-        SDL_Texture* calculateMandelbrot(const Mandelbrot* const fractal, const HighPrecDomain& domain, const Resolution& res) const;
-        SDL_Texture* calculateJulia(const Julia* const fractal, const HighPrecDomain& domain, const Resolution& res);
+        uint32_t* calculatePixels(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown = nullptr);
+
+        uint32_t* calculateMandelbrot(const Mandelbrot* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown = nullptr);
+        uint32_t* calculateJulia(const Julia* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown = nullptr);
 
         void forceRedraw();
 
@@ -102,12 +149,34 @@ class Graphics {
 
     private:
         SDL_Renderer* renderer;
+        SDL_Texture* screen;  // Last presented frame, to draw on top of
 
-        bool symmetry;  // Should use symmetry optimization
-
-        Coloring coloring;
+        // Set from the thread of the window, read by the render thread
+        std::atomic<bool> symmetry;  // Should use symmetry optimization
+        std::atomic<Coloring> coloring;
+        std::atomic<Palette> palette;
+        std::atomic<double> lineDetail;  // Width for exterior distance coloring. Higher value is more detail (thinner line)
+        std::atomic<bool> redrawForced;
 
         GraphicsState prev;
+        GraphicsState other;  // Last frame in the other coloring, so switching back only recolors it
+        bool unchanged;  // Render thread: this render was cancelled before it had a frame, so there's nothing to publish
+
+        CancelToken cancelToken;
+
+        // Finished frame waiting for present
+        std::mutex frameMutex;
+        uint32_t* frame;
+        Resolution frameRes;
+
+        // draw, without throwing away the frame kept for the other coloring
+        void drawFrame(const Fractal* const fractal, const HighPrecDomain& domain, const Resolution& res, const std::function<void()>& passShown);
+        // Colors the packed values of a frame into a new buffer
+        uint32_t* colorFrame(const uint32_t* const values, const Resolution& res, const Coloring c, const iter_t nMax) const;
+        // Takes ownership of pixels
+        void publishFrame(uint32_t* const pixels, const Resolution& res);
+        // Publishes the coarse passes of a progressive render, mirrored like the finished frame will be
+        PassFunction passPublisher(const Resolution& res, const iter_t nMax, const bool sym, const SDL_Rect& symFrom, const SDL_Rect& symTo, const std::function<void()>& passShown);
 
         // These are members so these GMP floats only have to be inited once
         HighPrecDomain newDomain;
@@ -8,6 +8,8 @@
 int eventFilter(void* userdata, SDL_Event* const e) {
     // Interrupt event
     if(e->type == SDL_KEYDOWN && e->key.keysym.sym == SDLK_ESCAPE) {
+        ((IOController*)userdata)->cancelRenders();
+
         SDL_FlushEvent(SDL_MOUSEWHEEL);
         SDL_FlushEvent(SDL_KEYDOWN);
         SDL_FlushEvent(SDL_KEYUP);
@@ -101,7 +103,9 @@ void IOController::mainWindowKeyEvent(const SDL_Keycode& sym, bool& quit) {
         case SDLK_p:            program->deepen();                          break;
         case SDLK_o:            program->unDeepen();                        break;
         case SDLK_g:            program->nextColoring();                    break;
+        case SDLK_v:            program->nextPalette();                     break;
         case SDLK_y:            program->toggleSymmetry();                  break;
+        case SDLK_e:            program->togglePeriodicity();               break;
     }
 }
 
@@ -182,6 +186,8 @@ void IOController::juliaWindowKeyEvent(const SDL_Keycode& sym, bool& quit) {
         case SDLK_LEFTBRACKET:  juliaWindow->changenMax(-1);                break;
         case SDLK_RIGHTBRACKET: juliaWindow->changenMax(1);                 break;
         case SDLK_g:            juliaWindow->nextColoring();                break;
+        case SDLK_e:            juliaWindow->togglePeriodicity();           break;
+        case SDLK_v:            juliaWindow->nextPalette();                 break;
         case SDLK_c:            program->hideJuliaWindow();                 break;
 
         // case SDLK_y:
@@ -238,6 +244,12 @@ void IOController::juliaWindowMouseMotion(const SDL_MouseMotionEvent& eMotion) {
 }
 
 
+void IOController::cancelRenders() {
+    program->cancel();
+    juliaWindow->cancel();
+}
+
+
 void IOController::mainLoop() {
     bool quit = false;
     SDL_Event e;
@@ -291,6 +303,16 @@ void IOController::mainLoop() {
                 else if(e.motion.windowID == juliaWindowID)
                     juliaWindowMouseMotion(e.motion);
                 break;
+
+            default:
+                // Frames come from the render threads as events, so the loop never waits for one
+                if(e.type == frameEvent()) {
+                    if(e.user.windowID == mainWindowID)
+                        program->present();
+                    else if(e.user.windowID == juliaWindowID)
+                        juliaWindow->present();
+                }
+                break;
         }
     }
 }
@@ -32,6 +32,9 @@ class IOController {
 
         void mainLoop();
 
+        // Stops the renders of both windows
+        void cancelRenders();
+
 
         bool ctrlHeldDown;
 
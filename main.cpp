@@ -3,6 +3,7 @@
 #include "console.h"
 #include "program.h"
 #include "graphics.h"
+#include "fracfast/threadPool.h"
 
 #include <SDL2/SDL.h>
 
@@ -19,6 +20,8 @@ void tests() {
     // noShapeSpeed();
     // borderCorrect();
     // borderSpeed();
+    // simdCorrect();
+    // scalarSpeed();
     // multiThreads();
     // multiSplits();
     // multiSpeed(/*8, 7*/);
@@ -29,15 +32,36 @@ void tests() {
     //     gmpFractalSpeedAll(t);
     // }
     // gmpScaleSpeed();
+    // perturbationCorrect();
+    // perturbationSpeed();
+    // doubleDoubleCorrect();
+    // schedulerSpeed(/*8, 7*/);
+    // cancelLatency();
+    // progressiveSpeed();
+    // recolorSpeed();
+    // marianiSilverSpeed();
+    // sharedTraceSpeed();
+    // periodicitySpeed();
+    // bulbSpeed();
     // doublePrec();
 }
 
 
 void parseArgs(unsigned int argc, char* argv[], unsigned int& width, unsigned int& height) {
+    unsigned int cores = threadPool().size();
+    bool pin = false;
+
     for(unsigned int i = 1; i < argc; i++) {
         if((strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--precision") == 0) && argc > i + 1) {
-            // TODO: Start with given arbitrary precision
-            std::cout << "Setting precision on startup is not implemented yet!" << std::endl;
+            // Minimum precision of the domain; Program raises it further when zooming in deeper than it can hold
+            const int prec = atoi(argv[i + 1]);
+
+            if(prec <= 0)
+                std::cout << "Incorrect value for precision. Skipping " << argv[i] << ' ' << argv[i + 1] << '.' << std::endl;
+            else
+                mpf_set_default_prec(prec);
+
+            i++;  // Advance 1 extra argument
         }
         else if((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--resolution") == 0) && argc > i + 2) {
             width = atoi(argv[i + 1]);
@@ -51,6 +75,19 @@ void parseArgs(unsigned int argc, char* argv[], unsigned int& width, unsigned in
 
             i += 2;  // Advance 2 extra arguments
         }
+        else if((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cores") == 0) && argc > i + 1) {
+            const int c = atoi(argv[i + 1]);
+
+            if(c <= 0)
+                std::cout << "Incorrect value for cores. Skipping " << argv[i] << ' ' << argv[i + 1] << '.' << std::endl;
+            else
+                cores = c;
+
+            i++;  // Advance 1 extra argument
+        }
+        else if(strcmp(argv[i], "--pin") == 0) {
+            pin = true;
+        }
         else if(strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--test") == 0) {
             tests();
             exit(EXIT_SUCCESS);
@@ -66,6 +103,8 @@ void parseArgs(unsigned int argc, char* argv[], unsigned int& width, unsigned in
                       << "Flags:\n"
                       << "  (-p | --precision) [p]        - Sets precision to p bits\n"
                       << "  (-r | --resolution) [x] [y]   - Run fraccert in x by y pixels\n"
+                      << "  (-c | --cores) [n]            - Render with n threads\n"
+                      << "  --pin                         - Pin every render thread to its own core\n"
                       << "  (-t | --tests)                - Run tests\n"
                       << "  (-h | --help)                 - Prints help\n"
                       << "\n"
@@ -74,6 +113,8 @@ void parseArgs(unsigned int argc, char* argv[], unsigned int& width, unsigned in
                       << "WASD or arrow keys to translate.\n"
                       << "T to toggle between Mandelbrot and Julia.\n"
                       << "G to toggle coloring method.\n"
+                      << "V to cycle through the palettes.\n"
+                      << "E to toggle periodicity checking (early exit for points in the set).\n"
                       << "H to return to the starting location\n"
                       << "IJKL to translate Julia c value.\n"
                       << "[] to change NMAX.\n"
@@ -81,6 +122,10 @@ void parseArgs(unsigned int argc, char* argv[], unsigned int& width, unsigned in
             exit(EXIT_SUCCESS);
         }
     }
+
+    // The thread pool is shared by all windows, so configure it before they render
+    if(cores != threadPool().size() || pin)
+        threadPool().configure(cores, pin);
 }
 
 
@@ -91,6 +136,9 @@ int main(int argc, char* argv[]) {
 
     parseArgs(argc, argv, width, height);
 
+    // The fracfast kernels are chosen at runtime for this CPU
+    std::cout << "Using " << kernels().name << " kernels" << std::endl;
+
     if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0) {
         printf("SDL could not initialize!\nSDL Error: %s\n", SDL_GetError());
         exit(EXIT_FAILURE);
@@ -113,11 +161,12 @@ int main(int argc, char* argv[]) {
 
     std::cout << std::endl;
 
-    delete juliaGraphics;
+    // The programs stop their render threads, which still use the graphics
     delete juliaWindow;
+    delete juliaGraphics;
 
-    delete graphics;
     delete program;
+    delete graphics;
     delete ioController;
     SDL_Quit();
 
@@ -3,10 +3,29 @@
 
 #include "select_scale.h"
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
 
+uint32_t frameEvent() {
+    static const uint32_t type = SDL_RegisterEvents(1);
+    return type;
+}
+
+
+// Copy of the fractal for the render thread; add other fractals here
+static Fractal* copyFractal(const Fractal* const fractal) {
+    switch(fractal->fractalType) {
+        case Fractals::Mandelbrot:  return new Mandelbrot(*(const Mandelbrot*)fractal);
+        case Fractals::Julia:       return new Julia(*(const Julia*)fractal);
+        case Fractals::None:        break;
+    }
+
+    return new Mandelbrot();
+}
+
+
 Program::Program(Graphics* const g, const unsigned int w, const unsigned int h, const uint32_t flags) : nDeepen(DEFAULTDEEPEN), graphics(g) {
     mpf_inits(domain.rMin, domain.rMax, domain.iMin, domain.iMax, xRatio, yRatio, dReal, dImag, t, scaleFactor, NULL);
     mpf_set_d(scaleFactor, SCALEFACTOR);
@@ -26,9 +45,26 @@ Program::Program(Graphics* const g, const unsigned int w, const unsigned int h,
     selection = nullptr;
 
     resetView();
+
+    frameEvent();  // Register it from this thread, before a render thread needs it
+    next.fractal = nullptr;
+    mpf_inits(next.domain.rMin, next.domain.rMax, next.domain.iMin, next.domain.iMax, NULL);
+    renderThread = std::thread(&Program::renderLoop, this);
 }
 
 Program::~Program() {
+    {
+        std::lock_guard<std::mutex> guard(requestMutex);
+        quitting = true;
+    }
+    graphics->cancel();
+    requestReady.notify_one();
+    renderThread.join();
+
+    if(next.fractal != nullptr)
+        delete next.fractal;
+    mpf_clears(next.domain.rMin, next.domain.rMax, next.domain.iMin, next.domain.iMax, NULL);
+
     mpf_clears(domain.rMin, domain.rMax, domain.iMin, domain.iMax, xRatio, yRatio, dReal, dImag, t, scaleFactor, NULL);
 
     delete fractal;
@@ -66,6 +102,23 @@ bool Program::isRendering() const {
     return rendering;
 }
 
+void Program::cancel() {
+    graphics->cancel();
+}
+
+void Program::present() {
+    lock(renderingMutex);
+
+    if(graphics->present()) {
+        if(juliaWinUp)
+            drawJuliaC();
+
+        graphics->blit();
+    }
+
+    unlock(renderingMutex);
+}
+
 
 unsigned int Program::getWindowID() const {
     return SDL_GetWindowID(window);
@@ -158,8 +211,8 @@ void Program::unDeepen() {
 void Program::setLineDetail(const double lineDetail) {
     lock(renderingMutex);
 
-    graphics->setLineDetail(fractal, lineDetail);
-    tick();
+    graphics->setLineDetail(lineDetail);
+    recolorTick();
 
     unlock(renderingMutex);
 }
@@ -169,7 +222,17 @@ void Program::nextColoring() {
     lock(renderingMutex);
 
     graphics->nextColoring();
-    tick();
+    recolorTick();
+
+    unlock(renderingMutex);
+}
+
+
+void Program::nextPalette() {
+    lock(renderingMutex);
+
+    graphics->nextPalette();
+    recolorTick();
 
     unlock(renderingMutex);
 }
@@ -264,36 +327,119 @@ void Program::redraw() {
 
 
 void Program::tick() {
-    graphics->setScreen();
+    fitPrecision();
+    requestRender(RenderKind::Draw);
+}
+
+void Program::translateTick() {
+    fitPrecision();
+    requestRender(RenderKind::Extend);
+}
+
+// The view didn't change, so the precision doesn't need to be fitted
+void Program::recolorTick() {
+    requestRender(RenderKind::Recolor);
+}
 
-    graphics->draw(fractal, domain, {res.w, res.h});
+// Called with renderingMutex held, so the state is consistent while it's copied
+void Program::requestRender(const RenderKind kind) {
+    std::lock_guard<std::mutex> guard(requestMutex);
 
-    if(juliaWinUp)
-        drawJuliaC();
+    // A request that is still waiting was never drawn, so it's merged into one doing the work of both
+    if(requested) {
+        delete next.fractal;
+        next.kind = std::max(next.kind, kind);
+    }
+    else
+        next.kind = kind;
+
+    next.fractal = copyFractal(fractal);
+    mpf_set_prec(next.domain.rMin, mpf_get_prec(domain.rMin)); mpf_set_prec(next.domain.rMax, mpf_get_prec(domain.rMax));
+    mpf_set_prec(next.domain.iMin, mpf_get_prec(domain.iMin)); mpf_set_prec(next.domain.iMax, mpf_get_prec(domain.iMax));
+    mpf_set(next.domain.rMin, domain.rMin); mpf_set(next.domain.rMax, domain.rMax); mpf_set(next.domain.iMin, domain.iMin); mpf_set(next.domain.iMax, domain.iMax);
+    next.res = res;
+    requested = true;
+
+    // The frame being calculated is out of date now, unless only its coloring is; it's colored when it's published
+    if(kind != RenderKind::Recolor)
+        graphics->cancel();
+    requestReady.notify_one();
+}
+
+void Program::renderLoop() {
+    RenderRequest current;
+    mpf_inits(current.domain.rMin, current.domain.rMax, current.domain.iMin, current.domain.iMax, NULL);
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(requestMutex);
+            requestReady.wait(lock, [this]() { return requested || quitting; });
+            if(quitting)
+                break;
+
+            current.fractal = next.fractal;
+            next.fractal = nullptr;
+            mpf_swap(current.domain.rMin, next.domain.rMin); mpf_swap(current.domain.rMax, next.domain.rMax);
+            mpf_swap(current.domain.iMin, next.domain.iMin); mpf_swap(current.domain.iMax, next.domain.iMax);
+            current.res = next.res;
+            current.kind = next.kind;
+            requested = false;
+
+            // Only a request after this one may cancel it
+            graphics->resetCancel();
+        }
+
+        graphics->setPrecision(mpf_get_prec(current.domain.rMin));
+        // Coarse passes are shown while the rest of the frame is calculated
+        switch(current.kind) {
+            case RenderKind::Recolor:   graphics->recolorDraw(current.fractal, current.domain, current.res, [this]() { frameReady(); });  break;
+            case RenderKind::Extend:    graphics->extendDraw(current.fractal, current.domain, current.res);                              break;
+            case RenderKind::Draw:      graphics->draw(current.fractal, current.domain, current.res, [this]() { frameReady(); });         break;
+        }
+        delete current.fractal;
+
+        // Don't show a frame that was cancelled for a newer one
+        {
+            std::lock_guard<std::mutex> guard(requestMutex);
+            if(requested)
+                continue;
+        }
+        graphics->publish();
+        frameReady();
+    }
 
-    graphics->blit();
+    mpf_clears(current.domain.rMin, current.domain.rMax, current.domain.iMin, current.domain.iMax, NULL);
 }
 
-void Program::translateTick() {
-    graphics->setScreen();
+void Program::frameReady() {
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = frameEvent();
+    e.user.windowID = SDL_GetWindowID(window);
+    SDL_PushEvent(&e);
+}
 
-    graphics->extendDraw(fractal, domain, {res.w, res.h});
+void Program::fitPrecision() {
+    const mp_bitcnt_t bits = planPrecision(domain, res).bits + PRECISIONHEADROOM;
+    if(mpf_get_prec(domain.rMin) >= bits)
+        return;
 
-    if(juliaWinUp)
-        drawJuliaC();
+    mpf_set_default_prec(bits);
 
-    graphics->blit();
+    // mpf_set_prec keeps the values, only rounded to the new precision
+    mpf_set_prec(domain.rMin, bits); mpf_set_prec(domain.rMax, bits); mpf_set_prec(domain.iMin, bits); mpf_set_prec(domain.iMax, bits);
+    mpf_set_prec(xRatio, bits); mpf_set_prec(yRatio, bits); mpf_set_prec(dReal, bits); mpf_set_prec(dImag, bits); mpf_set_prec(t, bits); mpf_set_prec(scaleFactor, bits);
 }
 
 void Program::deepenTick() {
-    graphics->setScreen();
-
     graphics->deepenDraw(fractal, domain, {res.w, res.h});
 
-    if(juliaWinUp)
-        drawJuliaC();
+    if(graphics->present()) {
+        if(juliaWinUp)
+            drawJuliaC();
 
-    graphics->blit();
+        graphics->blit();
+    }
 }
 
 
@@ -491,10 +637,22 @@ void Program::home() {
 }
 
 
+// nMax has to fit in iter_t, which can be as narrow as 16 bits (fracfast/types.h)
+static iter_t limitnMax(const unsigned long n) {
+    if(n > (unsigned long)MAXITERATIONS) {
+        std::cout << std::endl << "\rWarning: NMAX overflow. NMAX is set to " << (unsigned long)MAXITERATIONS << std::endl;
+        std::cout << "$ " << std::flush;
+
+        return MAXITERATIONS;
+    }
+
+    return n;
+}
+
 void Program::setnMax(const unsigned long n, const bool doTick) {
     lock(renderingMutex);
 
-    fractal->setnMax(n);
+    fractal->setnMax(limitnMax(n));
     if(doTick)
         tick();
 
@@ -516,7 +674,7 @@ void Program::changenMax(const long n) {
         fractal->setnMax(2);
     }
     else
-        fractal->setnMax(nMax + n);
+        fractal->setnMax(limitnMax(nMax + n));
 
     tick();
 
@@ -538,6 +696,20 @@ void Program::toggleSymmetry() {
 }
 
 
+void Program::togglePeriodicity() {
+    lock(renderingMutex);
+
+    const bool periodicity = !(fractal->getPeriodicity() > 0.0);
+    fractal->setPeriodicity(periodicity ? DEFAULTPERIODICITY : 0.0);
+
+    tick();
+    std::cout << "\rPeriodicity checking is " << (periodicity ? "on" : "off") << std::endl;
+    std::cout << "$ " << std::flush;
+
+    unlock(renderingMutex);
+}
+
+
 void Program::xyToComplex(const unsigned int x, const unsigned int y, double& c0, double& c1) const {
     const double pixelSize = (mpf_get_d(domain.rMax) - mpf_get_d(domain.rMin)) / (double)(res.w);
 
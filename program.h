@@ -10,7 +10,9 @@
 #include <SDL2/SDL.h>
 #include <gmp.h>
 
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 
 const unsigned int DEFAULTWIDTH = 800;
@@ -23,8 +25,30 @@ const double SCALEFACTOR = 0.8;
 
 const unsigned int DEFAULTDEEPEN = 50;
 
+// Extra bits the domain gets over what the current zoom needs, so the next zooms are calculated without losing precision
+const mp_bitcnt_t PRECISIONHEADROOM = 64;
 
-// All non-const public functions must lock/unlock 'rendering"
+
+// SDL event type the render threads push when a frame is ready, with user.windowID the window it's for
+uint32_t frameEvent();
+
+// What the render thread has to do for a request, from least to most work, so merged requests take the largest
+enum class RenderKind {
+    Recolor,  // Only the coloring changed
+    Extend,   // Recycle the pixels of the last frame, after translating
+    Draw
+};
+
+// Everything a frame depends on, copied from the program state, so the render thread never reads state that is being changed
+struct RenderRequest {
+    Fractal* fractal;  // Copy owned by the request
+    HighPrecDomain domain;
+    Resolution res;
+    RenderKind kind;
+};
+
+
+// All non-const public functions must lock/unlock 'rendering", except cancel
 // TODO: Seperate Window class
 class Program {
     public:
@@ -37,6 +61,12 @@ class Program {
         inline void unlock(std::mutex& m);
         bool isRendering() const;
 
+        // Stops the render in progress, keeping what is done on screen; doesn't lock, so it can be called from any thread
+        void cancel();
+
+        // Shows the newest frame of the render thread; called by the event loop for frameEvent()
+        void present();
+
         unsigned int getWindowID() const;
 
         void setC(const double c[2]);
@@ -53,6 +83,7 @@ class Program {
 
         void setLineDetail(const double lineDetail);
         void nextColoring();
+        void nextPalette();
 
         void setJuliaWindow(Program* const p);
 
@@ -78,6 +109,8 @@ class Program {
         void changenMax(const long n);
 
         void toggleSymmetry();
+        // Turns periodicity checking of the fractal off, or back on with the default tolerance
+        void togglePeriodicity();
 
         void xyToComplex(const unsigned int x, const unsigned int y, double& c0, double& c1) const;
         void xyToComplex(const unsigned int x, const unsigned int y, double c[2]) const;
@@ -109,9 +142,18 @@ class Program {
         Fractal* fractal;
 
         // Mutex for signaling then fractal is rendering. When fractal is rendering, no changes may be made to the program state and in extension, no changes to the fractal
+        // Frames are calculated on renderThread from a copy of the state, so this is only held while the state changes
         std::mutex renderingMutex;
         bool rendering;
 
+        // The newest requested frame replaces one that is waiting and cancels the one being calculated
+        std::thread renderThread;
+        std::mutex requestMutex;
+        std::condition_variable requestReady;
+        RenderRequest next;     // Guarded by requestMutex
+        bool requested = false; // Guarded by requestMutex
+        bool quitting = false;  // Guarded by requestMutex
+
         bool symmetry = true;
 
         // For hinding/showing the Julia window
@@ -133,12 +175,23 @@ class Program {
         void scaleXY(const int scaleDirection, const unsigned int x, const unsigned int y);
 
         // Draw fractal with current program state
+        // These only ask the render thread for a frame, it's shown when present is called
         void tick();
         void translateTick();
         void deepenTick();
+        void recolorTick();
+
+        void requestRender(const RenderKind kind);
+        void renderLoop();
+        // Tells the thread of the window a frame is waiting for present
+        void frameReady();
 
         void resetView();
 
+        // Raises the precision of the domain (and the GMP default) when zooming in further than it can hold
+        // The render thread raises the precision of Graphics to that of the domain it gets
+        void fitPrecision();
+
         void setResolution(const unsigned int w, const unsigned int h);
 };
 
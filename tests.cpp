@@ -1,11 +1,19 @@
 
 #include "fracfast/fractals.h"
+#include "fracfast/scheduler.h"
+#include "fracfast/threadPool.h"
 #include "locations.h"
 
 #include <omp.h>
 
+#include <atomic>
+#include <functional>
 #include <fstream>
 #include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <algorithm>
 
 
 // typedef std::chrono::steady_clock::time_point steady_clock;
@@ -37,7 +45,7 @@ void bruteforceSpeed() {
     for(int i = 0; i < TESTS; i++) {
         memset(p, 0x0, Locations::home.res.w * Locations::home.res.h * sizeof(uint32_t));
         START;
-        m->calcScreenBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, p);
+        m->calcScreenBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), p);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -60,7 +68,7 @@ void bruteforceSpeed() {
             memset(p, 0x0, Locations::averageRes.w * Locations::averageRes.h * sizeof(uint32_t));
             m->setnMax(locations[l].nMax);
             START;
-            m->calcScreenBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, p);
+            m->calcScreenBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), p);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -91,7 +99,7 @@ void symRef(SDL_Renderer* const renderer) {
 
     START;
     SDL_Texture* const texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, res.h);
-    m->calcScreenBruteforce(domain, res, {0, res.w, 0, res.h}, nullptr, p);
+    m->calcScreenBruteforce(domain, res, {0, res.w, 0, res.h}, RenderOptions(), p);
     SDL_UpdateTexture(texture, NULL, p, res.w * sizeof(uint32_t));
     END;
     std::cout << DURATION.count() << " ms" << std::endl;
@@ -129,7 +137,7 @@ void symCPU(SDL_Renderer* const renderer) {
             yMin = ((domain.iMax * res.h) / (domain.iMax - domain.iMin)) + 1;
     }
  
-    m->calcScreenBruteforce(domain, res, {0, res.w, yMin, yMax}, nullptr, p);
+    m->calcScreenBruteforce(domain, res, {0, res.w, yMin, yMax}, RenderOptions(), p);
 
     // Copy to top half
     for(unsigned int y = 0; y < yMin; y++)  //for(int y = yMin - 1; y >= 0; y--)
@@ -183,7 +191,7 @@ void symGPU(SDL_Renderer* const renderer) {
         }
     }
  
-    m->calcScreenBruteforce(domain, res, {0, res.w, yMin, yMax}, nullptr, p);
+    m->calcScreenBruteforce(domain, res, {0, res.w, yMin, yMax}, RenderOptions(), p);
 
     if(sym) {
         SDL_Texture* const tempTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, yMax - yMin);
@@ -248,7 +256,7 @@ void noShapeSpeed() {
     for(int i = 0; i < TESTS; i++) {
         memset(p, 0x0, Locations::home.res.w * Locations::home.res.h * sizeof(uint32_t));
         START;
-        m->calcScreenBruteforceNoShape(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, p);
+        m->calcScreenBruteforceNoShape(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), p);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -271,7 +279,7 @@ void noShapeSpeed() {
             memset(p, 0x0, Locations::averageRes.w * Locations::averageRes.h * sizeof(uint32_t));
             m->setnMax(locations[l].nMax);
             START;
-            m->calcScreenBruteforceNoShape(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, p);
+            m->calcScreenBruteforceNoShape(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), p);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -292,7 +300,7 @@ void shapeSpeed() {
     std::ofstream outfile("results/shape_home.txt", std::ofstream::app);
     CLOCKS;
 
-    ShapeVector shapes = {inCardioid, in2Bulb};
+    ShapeSet shapes = CARDIOID | BULB2;
     Mandelbrot* m = new Mandelbrot();
     uint32_t* p = new uint32_t[Locations::home.res.w * Locations::home.res.h];
 
@@ -302,7 +310,7 @@ void shapeSpeed() {
     for(int i = 0; i < TESTS; i++) {
         memset(p, 0x0, Locations::home.res.w * Locations::home.res.h * sizeof(uint32_t));
         START;
-        m->calcScreenBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, (void*)&shapes, p);
+        m->calcScreenBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(shapes), p);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -325,7 +333,7 @@ void shapeSpeed() {
             memset(p, 0x0, Locations::averageRes.w * Locations::averageRes.h * sizeof(uint32_t));
             m->setnMax(locations[l].nMax);
             START;
-            m->calcScreenBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, (void*)&shapes, p);
+            m->calcScreenBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(shapes), p);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -354,13 +362,13 @@ void borderCorrect() {
     // Home domain
     std::cout << "Home domain:" << std::endl << "Rendering fractals with and without border tracing..." << std::flush;
     m->setnMax(Locations::home.nMax);
-    m->calcScreenBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, brute);
-    m->calcScreen(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, border);
+    m->calcScreenBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), brute);
+    m->calcScreen(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), border);
 
     std::cout << "\rCounting mistakes                                    " << std::endl;
     unsigned int mistakes = 0;
     for(unsigned int i = 0; i < Locations::home.res.w * Locations::home.res.h; i++) {
-        if((brute[i] & 0xFFFFFF00) == (border[i] & 0xFFFFFF00))
+        if(brute[i] == border[i])
             continue;
 
         // std::cout << "Mismatch at " << std::dec << i / r.w << ", " << i % r.w << ". p = " << std::hex << p[i] << "  q = " << q[i] << std::endl;
@@ -382,11 +390,11 @@ void borderCorrect() {
         memset(brute, 0x0, Locations::averageRes.w * Locations::averageRes.h * sizeof(uint32_t));
         memset(border, 0x0, Locations::averageRes.w * Locations::averageRes.h * sizeof(uint32_t));
         m->setnMax(locations[l].nMax);
-        m->calcScreenBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, brute);
-        m->calcScreen(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, border);
+        m->calcScreenBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), brute);
+        m->calcScreen(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), border);
         
         for(unsigned int i = 0; i < Locations::averageRes.w * Locations::averageRes.h; i++) {
-            if((brute[i] & 0xFFFFFF00) == (border[i] & 0xFFFFFF00))
+            if(brute[i] == border[i])
                 continue;
 
             mistakes++;
@@ -401,6 +409,104 @@ void borderCorrect() {
     std::cout << std::endl;
 }
 
+void simdCorrect() {
+    std::cout << "Testing correctness of the vector kernels" << std::endl;
+
+    const Resolution& res = Locations::averageRes;
+    std::vector<double> cr(res.w), ci(res.w), dRef(res.w), d(res.w);
+    std::vector<iter_t> nRef(res.w), n(res.w);
+
+    Mandelbrot* m = new Mandelbrot();
+
+    const KernelSet* const scalar = kernels(KernelISA::Scalar);
+    for(auto isa : {KernelISA::SSE2, KernelISA::AVX2, KernelISA::AVX512}) {
+        const KernelSet* const k = kernels(isa);
+        if(k == nullptr)
+            continue;
+
+        unsigned int escapeMistakes = 0, distanceMistakes = 0;
+        for(int l = 0; l < LOCATIONS; l++) {
+            const Domain& dom = locations[l].dom;
+            const double pixelSize = (dom.rMax - dom.rMin) / (double)res.w,
+                         epsilon = m->getPeriodicity() * pixelSize;
+            for(unsigned int x = 0; x < res.w; x++)
+                cr[x] = dom.rMin + (x * pixelSize);
+
+            for(unsigned int y = 0; y < res.h; y++) {
+                std::fill(ci.begin(), ci.end(), dom.iMax - (y * pixelSize));
+
+                scalar->escapeTime(cr.data(), ci.data(), res.w, locations[l].nMax, epsilon, nRef.data());
+                k->escapeTime(cr.data(), ci.data(), res.w, locations[l].nMax, epsilon, n.data());
+                scalar->distance(cr.data(), ci.data(), res.w, locations[l].nMax, dRef.data());
+                k->distance(cr.data(), ci.data(), res.w, locations[l].nMax, d.data());
+
+                for(unsigned int x = 0; x < res.w; x++) {
+                    if(n[x] != nRef[x])
+                        escapeMistakes++;
+                    if(std::abs(d[x] - dRef[x]) > 1e-12 * std::abs(dRef[x]))
+                        distanceMistakes++;
+                }
+            }
+        }
+        std::cout << k->name << ": escape time mistakes = " << escapeMistakes << ", distance mistakes = " << distanceMistakes << " of " << res.w * res.h * LOCATIONS << " pixels" << std::endl;
+    }
+
+    // Vector brute force against calculating every pixel with calcPixel
+    ShapeSet shapes = CARDIOID | BULB2;
+    uint32_t* scalarPixels = new uint32_t[res.w * res.h];
+    uint32_t* simdPixels = new uint32_t[res.w * res.h];
+
+    unsigned int mistakes = 0;
+    for(int l = 0; l < LOCATIONS; l++) {
+        m->setnMax(locations[l].nMax);
+        m->calcScreenBruteforceScalar(locations[l].dom, res, {0, res.w, 0, res.h}, RenderOptions(shapes), scalarPixels);
+        m->calcScreenBruteforce(locations[l].dom, res, {0, res.w, 0, res.h}, RenderOptions(shapes), simdPixels);
+
+        for(unsigned int i = 0; i < res.w * res.h; i++)
+            if(scalarPixels[i] != simdPixels[i])
+                mistakes++;
+    }
+    std::cout << "Brute force with " << kernels().name << ": mistakes = " << mistakes << " of " << res.w * res.h * LOCATIONS << " pixels" << std::endl;
+
+    delete[] scalarPixels;
+    delete[] simdPixels;
+
+    delete m;
+    std::cout << std::endl;
+}
+
+void scalarSpeed() {
+    std::cout << "Testing brute forcing without vector kernel" << std::endl;
+    std::ofstream outfile("results/scalar_average.txt", std::ofstream::app);
+    CLOCKS;
+
+    ShapeSet shapes = CARDIOID | BULB2;
+    Mandelbrot* m = new Mandelbrot();
+    uint32_t* p = new uint32_t[Locations::averageRes.w * Locations::averageRes.h];
+
+    duration_t total = ZERO;
+    duration_t sumLocs;
+    for(int i = 0; i < TESTS; i++) {
+        sumLocs = ZERO;
+        for(int l = 0; l < LOCATIONS; l++) {
+            m->setnMax(locations[l].nMax);
+            START;
+            m->calcScreenBruteforceScalar(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(shapes), p);
+            END;
+            sumLocs += DURATION;
+            total += DURATION;
+        }
+        outfile << sumLocs.count() << std::endl;
+    }
+    std::cout << "Average: " << total.count() / TESTS << " ms on average" << std::endl;
+
+    delete[] p;
+    outfile.close();
+
+    delete m;
+    std::cout << std::endl;
+}
+
 void borderSpeed() {
     std::cout << "Testing border tracing" << std::endl;
     std::ofstream outfile("results/border_trace_home.txt", std::ofstream::app);
@@ -415,7 +521,7 @@ void borderSpeed() {
     for(int i = 0; i < TESTS; i++) {
         memset(p, 0x0, Locations::home.res.w * Locations::home.res.h * sizeof(uint32_t));
         START;
-        m->calcScreen(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, p);
+        m->calcScreen(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), p);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -438,7 +544,7 @@ void borderSpeed() {
             memset(p, 0x0, Locations::averageRes.w * Locations::averageRes.h * sizeof(uint32_t));
             m->setnMax(locations[l].nMax);
             START;
-            m->calcScreen(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, p);
+            m->calcScreen(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), p);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -472,7 +578,7 @@ void multiThreads() {
         total = ZERO;
         for(int i = 0; i < TESTS; i++) {
             START;
-            p = m->threadedRenderBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, t, 8);
+            p = m->threadedRenderBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), t, 8);
             END;
             outfile << DURATION.count() << std::endl;
             total += DURATION;
@@ -495,7 +601,7 @@ void multiThreads() {
             for(int l = 0; l < LOCATIONS; l++) {
                 m->setnMax(locations[l].nMax);
                 START;
-                p = m->threadedRenderBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, t, 8);
+                p = m->threadedRenderBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), t, 8);
                 END;
                 sumLocs += DURATION;
                 total += DURATION;
@@ -520,7 +626,7 @@ void multiThreads() {
         total = ZERO;
         for(int i = 0; i < TESTS; i++) {
             START;
-            p = m->threadedRender(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, t, 8);
+            p = m->threadedRender(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), t, 8);
             END;
             outfile << DURATION.count() << std::endl;
             total += DURATION;
@@ -542,7 +648,7 @@ void multiThreads() {
             for(int l = 0; l < LOCATIONS; l++) {
                 m->setnMax(locations[l].nMax);
                 START;
-                p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, t, 8);
+                p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), t, 8);
                 END;
                 sumLocs += DURATION;
                 total += DURATION;
@@ -576,7 +682,7 @@ void multiSplits() {
         total = ZERO;
         for(int i = 0; i < TESTS; i++) {
             START;
-            p = m->threadedRenderBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, 8, s);
+            p = m->threadedRenderBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), 8, s);
             END;
             outfile << DURATION.count() << std::endl;
             total += DURATION;
@@ -599,7 +705,7 @@ void multiSplits() {
             for(int l = 0; l < LOCATIONS; l++) {
                 m->setnMax(locations[l].nMax);
                 START;
-                p = m->threadedRenderBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, 8, s);
+                p = m->threadedRenderBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), 8, s);
                 END;
                 sumLocs += DURATION;
                 total += DURATION;
@@ -624,7 +730,7 @@ void multiSplits() {
         total = ZERO;
         for(int i = 0; i < TESTS; i++) {
             START;
-            p = m->threadedRender(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, 8, s);
+            p = m->threadedRender(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), 8, s);
             END;
             outfile << DURATION.count() << std::endl;
             total += DURATION;
@@ -646,7 +752,7 @@ void multiSplits() {
             for(int l = 0; l < LOCATIONS; l++) {
                 m->setnMax(locations[l].nMax);
                 START;
-                p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, 8, s);
+                p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), 8, s);
                 END;
                 sumLocs += DURATION;
                 total += DURATION;
@@ -679,7 +785,7 @@ void multiSpeed(int threads = 8, int splits = 7) {
     total = ZERO;
     for(int i = 0; i < TESTS; i++) {
         START;
-        p = m->threadedRenderBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, threads, splits);
+        p = m->threadedRenderBruteforce(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), threads, splits);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -700,7 +806,7 @@ void multiSpeed(int threads = 8, int splits = 7) {
         for(int l = 0; l < LOCATIONS; l++) {
             m->setnMax(locations[l].nMax);
             START;
-            p = m->threadedRenderBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, threads, splits);
+            p = m->threadedRenderBruteforce(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), threads, splits);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -723,7 +829,7 @@ void multiSpeed(int threads = 8, int splits = 7) {
     total = ZERO;
     for(int i = 0; i < TESTS; i++) {
         START;
-        p = m->threadedRender(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, threads, splits);
+        p = m->threadedRender(Locations::home.dom, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), threads, splits);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -743,7 +849,7 @@ void multiSpeed(int threads = 8, int splits = 7) {
         for(int l = 0; l < LOCATIONS; l++) {
             m->setnMax(locations[l].nMax);
             START;
-            p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, threads, splits);
+            p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), threads, splits);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -771,7 +877,7 @@ void allSpeeds() {
     Domain domain;
     Resolution res;
 
-    ShapeVector shapes = {inCardioid, in2Bulb};
+    ShapeSet shapes = CARDIOID | BULB2;
     Mandelbrot* m = new Mandelbrot();
     uint32_t* p = nullptr;
 
@@ -800,7 +906,7 @@ void allSpeeds() {
             }
         }
 
-        p = m->threadedRender(domain, res, {0, res.w, yMin, yMax}, (void*)&shapes, 8, 7);
+        p = m->threadedRender(domain, res, {0, res.w, yMin, yMax}, RenderOptions(shapes), 8, 7);
 
         if(sym) {
             SDL_Texture* const tempTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, res.w, yMax - yMin);
@@ -843,7 +949,7 @@ void allSpeeds() {
         for(int l = 0; l < LOCATIONS; l++) {
             m->setnMax(locations[l].nMax);
             START;
-            p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, (void*)&shapes, 8, 7);
+            p = m->threadedRender(locations[l].dom, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(shapes), 8, 7);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -916,7 +1022,7 @@ void gmpBruteforceSpeed(int prec = 0) {
     // for(int i = 0; i < TESTS; i++) {
         memset(p, 0x0, Locations::home.res.w * Locations::home.res.h * sizeof(uint32_t));
         START;
-        m->calcScreenGMPBruteforce(d, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, p);
+        m->calcScreenGMPBruteforce(d, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), p);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -940,7 +1046,7 @@ void gmpBruteforceSpeed(int prec = 0) {
             mpf_set_d(d.rMin, locations[l].dom.rMin); mpf_set_d(d.rMax, locations[l].dom.rMax); mpf_set_d(d.iMin, locations[l].dom.iMin); mpf_set_d(d.iMax, locations[l].dom.iMax);
             m->setnMax(locations[l].nMax);
             START;
-            m->calcScreenGMPBruteforce(d, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, p);
+            m->calcScreenGMPBruteforce(d, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), p);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -978,7 +1084,7 @@ void gmpBordertraceSpeed(int prec = 0) {
     // for(int i = 0; i < TESTS; i++) {
         memset(p, 0x0, Locations::home.res.w * Locations::home.res.h * sizeof(uint32_t));
         START;
-        m->calcScreenGMP(d, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, nullptr, p);
+        m->calcScreenGMP(d, Locations::home.res, {0, Locations::home.res.w, 0, Locations::home.res.h}, RenderOptions(), p);
         END;
         outfile << DURATION.count() << std::endl;
         total += DURATION;
@@ -1001,7 +1107,7 @@ void gmpBordertraceSpeed(int prec = 0) {
             mpf_set_d(d.rMin, locations[l].dom.rMin); mpf_set_d(d.rMax, locations[l].dom.rMax); mpf_set_d(d.iMin, locations[l].dom.iMin); mpf_set_d(d.iMax, locations[l].dom.iMax);
             m->setnMax(locations[l].nMax);
             START;
-            m->calcScreenGMP(d, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, nullptr, p);
+            m->calcScreenGMP(d, Locations::averageRes, {0, Locations::averageRes.w, 0, Locations::averageRes.h}, RenderOptions(), p);
             END;
             sumLocs += DURATION;
             total += DURATION;
@@ -1033,6 +1139,598 @@ void gmpFractalSpeedAll(int t) {
 }
 
 
+
+// Centers d around c with the given width; the numbers are strings so they can be given with any precision
+static void setDeepDomain(HighPrecDomain& d, const char* cr, const char* ci, const char* width, const Resolution& res) {
+    mpf_t t;
+    mpf_init(t);
+
+    mpf_set_str(d.rMin, cr, 10); mpf_set_str(d.rMax, cr, 10);
+    mpf_set_str(d.iMin, ci, 10); mpf_set_str(d.iMax, ci, 10);
+
+    mpf_set_str(t, width, 10);
+    mpf_div_ui(t, t, 2);
+    mpf_sub(d.rMin, d.rMin, t);
+    mpf_add(d.rMax, d.rMax, t);
+
+    mpf_mul_ui(t, t, res.h);
+    mpf_div_ui(t, t, res.w);
+    mpf_sub(d.iMin, d.iMin, t);
+    mpf_add(d.iMax, d.iMax, t);
+
+    mpf_clear(t);
+}
+
+// Deep locations for the perturbation tests: around the Misiurewicz point i (exact at any depth) and in seahorse valley
+// Beyond 1e-308 the pixel size doesn't fit in a double anymore
+static const int DEEPLOCATIONS = 6;
+static const struct {
+    const char* cr;
+    const char* ci;
+    const char* width;
+    iter_t nMax;
+    unsigned int prec;  // Bits for GMP
+} deepLocations[DEEPLOCATIONS] = {
+    {"0", "1", "1e-30", 2000, 192},
+    {"0", "1", "1e-100", 2000, 416},
+    {"0", "1", "1e-300", 2000, 1088},
+    {"0", "1", "1e-400", 2000, 1408},
+    {"0", "1", "1e-1000", 6000, 3392},
+    {"-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", "1e-24", 20000, 192}
+};
+
+void perturbationCorrect() {
+    std::cout << "Testing correctness of perturbation against GMP" << std::endl;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution res = {192, 108};
+    uint32_t* p1 = new uint32_t[res.w * res.h];
+    uint32_t* p2 = new uint32_t[res.w * res.h];
+
+    HighPrecDomain d;
+    PerturbationStats stats;
+    RenderOptions options;
+    options.stats = &stats;
+    for(int l = 0; l < DEEPLOCATIONS; l++) {
+        mpf_set_default_prec(deepLocations[l].prec);
+        mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+        setDeepDomain(d, deepLocations[l].cr, deepLocations[l].ci, deepLocations[l].width, res);
+        m->setnMax(deepLocations[l].nMax);
+
+        m->calcScreenGMPBruteforce(d, res, {0, res.w, 0, res.h}, RenderOptions(), p1);
+        m->calcScreenPerturbation(d, res, {0, res.w, 0, res.h}, options, p2);
+
+        unsigned int mistakes = 0;
+        for(unsigned int i = 0; i < res.w * res.h; i++)
+            if(p1[i] != p2[i])
+                mistakes++;
+        std::cout << "Width " << deepLocations[l].width << ": mistakes = " << mistakes << " of " << res.w * res.h << " pixels, "
+                  << stats.references << " references, " << stats.glitched << " glitched, " << stats.skipped << " iterations skipped" << std::endl;
+
+        mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    }
+
+    delete[] p1;
+    delete[] p2;
+    delete m;
+    mpf_set_default_prec(64);
+    std::cout << std::endl;
+}
+
+void perturbationSpeed() {
+    std::cout << "Testing perturbation speed against GMP" << std::endl;
+    std::ofstream outfile("results/gmp/perturbation.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution res = {192, 108};
+    uint32_t* p = new uint32_t[res.w * res.h];
+
+    HighPrecDomain d;
+    for(int l = 0; l < DEEPLOCATIONS; l++) {
+        mpf_set_default_prec(deepLocations[l].prec);
+        mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+        setDeepDomain(d, deepLocations[l].cr, deepLocations[l].ci, deepLocations[l].width, res);
+        m->setnMax(deepLocations[l].nMax);
+
+        START;
+        m->calcScreenGMPBruteforce(d, res, {0, res.w, 0, res.h}, RenderOptions(), p);
+        END;
+        const duration_t gmp = DURATION;
+
+        PerturbationStats stats;
+        RenderOptions options;
+        options.stats = &stats;
+        START;
+        m->calcScreenPerturbation(d, res, {0, res.w, 0, res.h}, options, p);
+        END;
+        const duration_t perturbation = DURATION;
+
+        outfile << deepLocations[l].width << ' ' << gmp.count() << ' ' << perturbation.count() << ' ' << stats.skipped << std::endl;
+        std::cout << "Width " << deepLocations[l].width << ": GMP " << gmp.count() << " ms, perturbation " << perturbation.count()
+                  << " ms (" << gmp.count() / perturbation.count() << "x), skipped " << stats.skipped << " iterations" << std::endl;
+
+        mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    }
+
+    delete[] p;
+    delete m;
+    mpf_set_default_prec(64);
+    outfile.close();
+    std::cout << std::endl;
+}
+
+// Double-double is meant for pixel sizes between about 1e-13 and 1e-28
+void doubleDoubleCorrect() {
+    std::cout << "Testing correctness and speed of double-double against GMP" << std::endl;
+    std::ofstream outfile("results/gmp/doubledouble.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution res = {192, 108};
+    uint32_t* p1 = new uint32_t[res.w * res.h];
+    uint32_t* p2 = new uint32_t[res.w * res.h];
+
+    const struct {
+        const char* cr;
+        const char* ci;
+        const char* width;
+    } locations[4] = {
+        {"0", "1", "1e-12"},
+        {"0", "1", "1e-24"},
+        {"-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", "1e-14"},
+        {"-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", "1e-24"}
+    };
+
+    mpf_set_default_prec(192);
+    m->setnMax(5000);
+    HighPrecDomain d;
+    mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    for(int l = 0; l < 4; l++) {
+        setDeepDomain(d, locations[l].cr, locations[l].ci, locations[l].width, res);
+
+        START;
+        m->calcScreenGMPBruteforce(d, res, {0, res.w, 0, res.h}, RenderOptions(), p1);
+        END;
+        const duration_t gmp = DURATION;
+
+        memset(p2, 0x0, res.w * res.h * sizeof(uint32_t));
+        START;
+        m->calcScreenDoubleDouble(d, res, {0, res.w, 0, res.h}, RenderOptions(), p2);
+        END;
+        const duration_t dd = DURATION;
+
+        unsigned int mistakes = 0;
+        for(unsigned int i = 0; i < res.w * res.h; i++)
+            if(p1[i] != p2[i])
+                mistakes++;
+
+        outfile << locations[l].width << ' ' << gmp.count() << ' ' << dd.count() << ' ' << mistakes << std::endl;
+        std::cout << "Width " << locations[l].width << ": mistakes = " << mistakes << " of " << res.w * res.h << " pixels, GMP "
+                  << gmp.count() << " ms, double-double " << dd.count() << " ms (" << gmp.count() / dd.count() << "x)" << std::endl;
+    }
+    mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+
+    delete[] p1;
+    delete[] p2;
+    delete m;
+    mpf_set_default_prec(64);
+    outfile.close();
+    std::cout << std::endl;
+}
+
+// The scheme renderTiles replaced: 1 << splits blocks up front, claimed through a shared counter
+static void criticalRender(const Range& range, const TileFunction& renderTile, int cores, int splits) {
+    std::vector<Range> blocks = {range};
+    for(int i = 0; i < splits; i++) {
+        std::vector<Range> newBlocks;
+        for(auto& b : blocks) {
+            if(b.xMax - b.xMin > b.yMax - b.yMin) {
+                newBlocks.push_back({b.xMin, b.xMin + ((b.xMax - b.xMin) / 2), b.yMin, b.yMax});
+                newBlocks.push_back({b.xMin + ((b.xMax - b.xMin) / 2), b.xMax, b.yMin, b.yMax});
+            }
+            else {
+                newBlocks.push_back({b.xMin, b.xMax, b.yMin, b.yMin + ((b.yMax - b.yMin) / 2)});
+                newBlocks.push_back({b.xMin, b.xMax, b.yMin + ((b.yMax - b.yMin) / 2), b.yMax});
+            }
+        }
+        blocks = newBlocks;
+    }
+
+    std::atomic<int> lastBlock(0);
+    const int totalBlocks = 1 << splits;
+    threadPool().run(cores, [&](const unsigned int) {
+        while(true) {
+            const int blocknum = lastBlock++;
+            if(blocknum >= totalBlocks)
+                break;
+
+            renderTile(blocks[blocknum]);
+        }
+    });
+}
+
+// Work stealing against the old block counter, on the average locations and a deep double-double location where the blocks are very uneven
+void schedulerSpeed(int threads = 8, int splits = 7) {
+    std::cout << "Testing work stealing against the block counter with border trace" << std::endl;
+    std::ofstream outfile("results/threading/scheduler.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution& res = Locations::averageRes;
+    uint32_t* p = new uint32_t[res.w * res.h];
+    duration_t counter = ZERO, stealing = ZERO;
+
+    for(int l = 0; l < LOCATIONS; l++) {
+        m->setnMax(locations[l].nMax);
+        const TileFunction tile = [&](const Range& r) { m->calcScreen(locations[l].dom, res, r, RenderOptions(), p); };
+
+        memset(p, 0x0, res.w * res.h * sizeof(uint32_t));
+        START;
+        criticalRender({0, res.w, 0, res.h}, tile, threads, splits);
+        END;
+        counter += DURATION;
+
+        memset(p, 0x0, res.w * res.h * sizeof(uint32_t));
+        START;
+        renderTiles({0, res.w, 0, res.h}, tile, threads, splits);
+        END;
+        stealing += DURATION;
+    }
+    outfile << "average " << counter.count() << ' ' << stealing.count() << std::endl;
+    std::cout << "Average: block counter " << counter.count() << " ms, work stealing " << stealing.count() << " ms" << std::endl;
+
+    mpf_set_default_prec(192);
+    HighPrecDomain d;
+    mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    setDeepDomain(d, "-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", "1e-20", res);
+    m->setnMax(5000);
+    const TileFunction tile = [&](const Range& r) { m->calcScreenDoubleDouble(d, res, r, RenderOptions(), p); };
+
+    memset(p, 0x0, res.w * res.h * sizeof(uint32_t));
+    START;
+    criticalRender({0, res.w, 0, res.h}, tile, threads, splits);
+    END;
+    counter = DURATION;
+
+    memset(p, 0x0, res.w * res.h * sizeof(uint32_t));
+    START;
+    renderTiles({0, res.w, 0, res.h}, tile, threads, splits);
+    END;
+    stealing = DURATION;
+
+    outfile << "deep " << counter.count() << ' ' << stealing.count() << std::endl;
+    std::cout << "Deep: block counter " << counter.count() << " ms, work stealing " << stealing.count() << " ms" << std::endl;
+
+    mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    mpf_set_default_prec(64);
+    delete[] p;
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}
+
+// Time from cancelling a render, 50 ms after it started, until it returns; every render is much longer than that when it isn't cancelled
+void cancelLatency() {
+    std::cout << "Testing how fast renders stop after a cancel" << std::endl;
+    std::ofstream outfile("results/threading/cancel.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution& res = Locations::averageRes;
+    uint32_t* p = new uint32_t[res.w * res.h];
+    CancelToken cancel;
+    const RenderOptions options(NOSHAPES, &cancel);
+
+    mpf_set_default_prec(192);
+    HighPrecDomain d;
+    mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    setDeepDomain(d, "-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", "1e-20", res);
+    m->setnMax(std::min<unsigned long>(1000000, MAXITERATIONS));  // Lower with 16 bit iteration counts (fracfast/types.h)
+
+    const struct {
+        const char* name;
+        std::function<void()> render;
+    } renders[4] = {
+        {"border trace", [&]() { delete[] m->threadedRender(Locations::a.dom, res, {0, res.w, 0, res.h}, options); }},
+        {"brute force", [&]() { delete[] m->threadedRenderBruteforce(Locations::a.dom, res, {0, res.w, 0, res.h}, options); }},
+        {"double-double", [&]() { delete[] m->threadedRenderDoubleDouble(d, res, {0, res.w, 0, res.h}, options); }},
+        {"perturbation", [&]() { m->calcScreenPerturbation(d, res, {0, res.w, 0, res.h}, options, p); }}
+    };
+
+    for(int i = 0; i < 4; i++) {
+        cancel.reset();
+        std::thread renderer(renders[i].render);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        START;
+        cancel.cancel();
+        renderer.join();
+        END;
+
+        outfile << renders[i].name << ' ' << DURATION.count() << std::endl;
+        std::cout << "Cancelled " << renders[i].name << " in " << DURATION.count() << " ms" << std::endl;
+    }
+
+    mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    mpf_set_default_prec(64);
+    delete[] p;
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}
+
+
+// Time until the first pass of a progressive render is shown and until it's done, against a normal render; the finished frames should be the same
+void progressiveSpeed() {
+    std::cout << "Testing progressive rendering against a single pass" << std::endl;
+    std::ofstream outfile("results/threading/progressive.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution& res = Locations::averageRes;
+    duration_t single = ZERO, first = ZERO, progressive = ZERO;
+    unsigned int mistakes = 0;
+
+    std::chrono::steady_clock::time_point firstPass;
+    const PassFunction passDone = [&](const uint32_t*, const unsigned int step) {
+        if(step == 4)
+            firstPass = std::chrono::steady_clock::now();
+    };
+
+    for(int l = 0; l < LOCATIONS; l++) {
+        m->setnMax(locations[l].nMax);
+
+        START;
+        uint32_t* p1 = m->threadedRender(locations[l].dom, res, {0, res.w, 0, res.h}, RenderOptions());
+        END;
+        single += DURATION;
+
+        START;
+        uint32_t* p2 = m->progressiveRender(locations[l].dom, res, {0, res.w, 0, res.h}, RenderOptions(), passDone);
+        END;
+        progressive += DURATION;
+        first += std::chrono::duration_cast<duration_t>(firstPass - start);
+
+        for(unsigned int i = 0; i < res.w * res.h; i++)
+            if(p1[i] != p2[i])
+                mistakes++;
+
+        delete[] p1;
+        delete[] p2;
+    }
+
+    outfile << single.count() << ' ' << first.count() << ' ' << progressive.count() << ' ' << mistakes << std::endl;
+    std::cout << "Total: single pass " << single.count() << " ms, first pass shown after " << first.count() << " ms, progressive done after "
+              << progressive.count() << " ms, " << mistakes << " pixels differ" << std::endl;
+
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}
+
+void sharedTraceSpeed() {
+    std::cout << "Testing one border trace shared by all threads against one per tile" << std::endl;
+    std::ofstream outfile("results/threading/shared.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution& res = Locations::averageRes;
+    const Range range = {0, res.w, 0, res.h};
+    uint32_t* single = new uint32_t[res.w * res.h];
+    duration_t tiled = ZERO, shared = ZERO;
+    unsigned int different = 0;
+
+    for(int l = 0; l < LOCATIONS; l++) {
+        m->setnMax(locations[l].nMax);
+        m->calcScreen(locations[l].dom, res, range, RenderOptions(), single);  // The shared trace should give the same pixels as one trace over the whole screen
+
+        START;
+        uint32_t* p1 = m->threadedRender(locations[l].dom, res, range, RenderOptions());
+        END;
+        tiled += DURATION;
+
+        START;
+        uint32_t* p2 = m->threadedRenderShared(locations[l].dom, res, range, RenderOptions());
+        END;
+        shared += DURATION;
+
+        for(unsigned int i = 0; i < res.w * res.h; i++)
+            different += (p2[i] != single[i]);
+
+        delete[] p1;
+        delete[] p2;
+    }
+
+    outfile << threadPool().size() << ' ' << tiled.count() << ' ' << shared.count() << ' ' << different << std::endl;
+    std::cout << "Total: per tile " << tiled.count() << " ms, shared " << shared.count() << " ms, "
+              << different << " pixels differ from a single border trace" << std::endl;
+
+    delete[] single;
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}
+
+void periodicitySpeed() {
+    std::cout << "Testing periodicity checking against iterating interior points up to nMax" << std::endl;
+    std::ofstream outfile("results/periodicity.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    ShapeSet shapes = CARDIOID | BULB2;
+    const Resolution& res = Locations::averageRes;
+    const Range range = {0, res.w, 0, res.h};
+
+    // The test locations are mostly boundary, so the home view is added for the minibrots and bulbs the shapes don't cover
+    std::vector<Location> views(locations, locations + LOCATIONS);
+    views.push_back({Locations::home.dom, res, Locations::home.nMax});
+
+    // Also with ten times their nMax, which deeper zooms need; the border trace only iterates interior points along the edges of the set
+    for(const iter_t factor : {1, 10}) {
+        duration_t off[2] = {ZERO, ZERO}, on[2] = {ZERO, ZERO};
+        unsigned int mistakes = 0;
+        unsigned long periodic[2] = {0, 0};
+
+        for(auto& view : views) {
+            m->setnMax(view.nMax * factor);
+
+            for(int trace = 0; trace < 2; trace++) {
+                auto renderView = [&]() {
+                    return trace ? m->threadedRender(view.dom, res, range, RenderOptions(shapes)) : m->threadedRenderBruteforce(view.dom, res, range, RenderOptions(shapes));
+                };
+
+                m->setPeriodicity(0.0);
+                START;
+                uint32_t* p1 = renderView();
+                END;
+                off[trace] += DURATION;
+
+                m->setPeriodicity(DEFAULTPERIODICITY);
+                START;
+                uint32_t* p2 = renderView();
+                END;
+                on[trace] += DURATION;
+                periodic[trace] += m->takePeriodicCount();
+
+                for(unsigned int i = 0; i < res.w * res.h; i++)
+                    mistakes += (p2[i] != p1[i]);
+
+                delete[] p1;
+                delete[] p2;
+            }
+        }
+
+        outfile << factor << ' ' << off[0].count() << ' ' << on[0].count() << ' ' << off[1].count() << ' ' << on[1].count() << ' '
+                << periodic[0] << ' ' << periodic[1] << ' ' << mistakes << std::endl;
+        std::cout << "nMax x" << factor << ", brute force: without " << off[0].count() << " ms, with " << on[0].count() << " ms (" << off[0].count() / on[0].count() << "x), "
+                  << periodic[0] << " points periodic" << std::endl
+                  << "nMax x" << factor << ", border trace: without " << off[1].count() << " ms, with " << on[1].count() << " ms (" << off[1].count() / on[1].count() << "x), "
+                  << periodic[1] << " points periodic" << std::endl
+                  << mistakes << " pixels differ" << std::endl;
+    }
+
+    // In GMP every interior iteration is several mpf multiplies; the home view in a small resolution, as it's slow either way
+    const Resolution gmpRes = {240, 135};
+    const Domain& dom = Locations::home.dom;
+    HighPrecDomain d;
+    mpf_inits(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+    mpf_set_d(d.rMin, dom.rMin); mpf_set_d(d.rMax, dom.rMax); mpf_set_d(d.iMin, dom.iMin); mpf_set_d(d.iMax, dom.iMax);
+    m->setnMax(5 * Locations::home.nMax);
+
+    m->setPeriodicity(0.0);
+    START;
+    uint32_t* p1 = m->threadedRenderGMP(d, gmpRes, {0, gmpRes.w, 0, gmpRes.h}, RenderOptions());
+    END;
+    const duration_t off = DURATION;
+
+    m->setPeriodicity(DEFAULTPERIODICITY);
+    START;
+    uint32_t* p2 = m->threadedRenderGMP(d, gmpRes, {0, gmpRes.w, 0, gmpRes.h}, RenderOptions());
+    END;
+    const duration_t on = DURATION;
+
+    unsigned int mistakes = 0;
+    for(unsigned int i = 0; i < gmpRes.w * gmpRes.h; i++)
+        mistakes += (p2[i] != p1[i]);
+
+    outfile << "gmp " << off.count() << ' ' << on.count() << ' ' << m->takePeriodicCount() << ' ' << mistakes << std::endl;
+    std::cout << "GMP: without " << off.count() << " ms, with " << on.count() << " ms (" << off.count() / on.count() << "x), " << mistakes << " pixels differ" << std::endl;
+
+    delete[] p1;
+    delete[] p2;
+    mpf_clears(d.rMin, d.rMax, d.iMin, d.iMax, NULL);
+
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}
+
+void marianiSilverSpeed() {
+    std::cout << "Testing Mariani-Silver against border tracing" << std::endl;
+    std::ofstream outfile("results/mariani_silver.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution& res = Locations::averageRes;
+    const Range range = {0, res.w, 0, res.h};
+    duration_t borderTotal = ZERO, marianiTotal = ZERO;
+    unsigned int borderMistakes = 0, marianiMistakes = 0;
+
+    for(int l = 0; l < LOCATIONS; l++) {
+        m->setnMax(locations[l].nMax);
+        uint32_t* brute = m->threadedRenderBruteforce(locations[l].dom, res, range, RenderOptions());
+
+        START;
+        uint32_t* border = m->threadedRender(locations[l].dom, res, range, RenderOptions());
+        END;
+        const duration_t borderTime = DURATION;
+
+        START;
+        uint32_t* mariani = m->threadedRenderMarianiSilver(locations[l].dom, res, range, RenderOptions());
+        END;
+        const duration_t marianiTime = DURATION;
+
+        unsigned int bm = 0, mm = 0;
+        for(unsigned int i = 0; i < res.w * res.h; i++) {
+            bm += (border[i] != brute[i]);
+            mm += (mariani[i] != brute[i]);
+        }
+
+        outfile << l << ' ' << borderTime.count() << ' ' << marianiTime.count() << ' ' << bm << ' ' << mm << std::endl;
+        std::cout << "Location " << l << ": border trace " << borderTime.count() << " ms (" << bm << " mistakes), Mariani-Silver "
+                  << marianiTime.count() << " ms (" << mm << " mistakes)" << std::endl;
+        borderTotal += borderTime; marianiTotal += marianiTime;
+        borderMistakes += bm; marianiMistakes += mm;
+
+        delete[] brute;
+        delete[] border;
+        delete[] mariani;
+    }
+
+    std::cout << "Total: border trace " << borderTotal.count() << " ms (" << borderMistakes << " mistakes), Mariani-Silver "
+              << marianiTotal.count() << " ms (" << marianiMistakes << " mistakes)" << std::endl;
+
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}
+
+void recolorSpeed() {
+    std::cout << "Testing recoloring a frame against calculating it again" << std::endl;
+    std::ofstream outfile("results/threading/recolor.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    const Resolution& res = Locations::averageRes;
+    duration_t render = ZERO, recolor = ZERO;
+    uint32_t* pixels = new uint32_t[res.w * res.h];
+
+    for(int l = 0; l < LOCATIONS; l++) {
+        m->setnMax(locations[l].nMax);
+
+        START;
+        uint32_t* values = m->threadedRender(locations[l].dom, res, {0, res.w, 0, res.h}, RenderOptions());
+        END;
+        render += DURATION;
+
+        START;
+        colorIterations(values, pixels, res.w * res.h, locations[l].nMax, Palette::Cyclic);
+        END;
+        recolor += DURATION;
+
+        delete[] values;
+    }
+
+    outfile << render.count() << ' ' << recolor.count() << std::endl;
+    std::cout << "Total: rendering " << render.count() << " ms, recoloring " << recolor.count() << " ms" << std::endl;
+
+    delete[] pixels;
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}
+
 void lowPrecScale() {
     const double scaleFactor = 0.8;
     const int x = 250, y = 350;
@@ -1198,3 +1896,56 @@ void speedPrecSetDom() {
 
     mpf_clears(rMin, rMax, iMin, iMax, iCenter, iHeight, t, NULL);
 }*/
+
+void bulbSpeed() {
+    std::cout << "Testing the table of bulbs against only the cardioid and the period 2 bulb" << std::endl;
+    std::ofstream outfile("results/bulbs.txt", std::ofstream::app);
+    CLOCKS;
+
+    Mandelbrot* m = new Mandelbrot();
+    ShapeSet shapes = CARDIOID | BULB2;
+    ShapeSet bulbs = CARDIOID | BULB2 | BULBS;
+    const Resolution& res = Locations::averageRes;
+    const Range range = {0, res.w, 0, res.h};
+
+    // The home view and the period 3 bulb and the bulbs on the period 2 bulb, where the table covers most of the interior
+    std::vector<Location> views(locations, locations + LOCATIONS);
+    views.push_back({Locations::home.dom, res, Locations::home.nMax});
+    views.push_back({{-0.3, 0.05, 0.6, 0.9}, res, Locations::home.nMax});
+    views.push_back({{-1.45, -1.05, 0.0, 0.35}, res, Locations::home.nMax});
+
+    // Periodicity checking already stops interior points early, so with it the gain is smaller
+    for(const double periodicity : {0.0, DEFAULTPERIODICITY}) {
+        m->setPeriodicity(periodicity);
+        duration_t without = ZERO, with = ZERO;
+        unsigned int mistakes = 0;
+
+        for(auto& view : views) {
+            m->setnMax(view.nMax);
+
+            START;
+            uint32_t* p1 = m->threadedRenderBruteforce(view.dom, res, range, RenderOptions(shapes));
+            END;
+            without += DURATION;
+
+            START;
+            uint32_t* p2 = m->threadedRenderBruteforce(view.dom, res, range, RenderOptions(bulbs));
+            END;
+            with += DURATION;
+
+            for(unsigned int i = 0; i < res.w * res.h; i++)
+                mistakes += (p2[i] != p1[i]);
+
+            delete[] p1;
+            delete[] p2;
+        }
+
+        outfile << periodicity << ' ' << without.count() << ' ' << with.count() << ' ' << mistakes << std::endl;
+        std::cout << "Periodicity " << periodicity << ": without " << without.count() << " ms, with " << with.count() << " ms ("
+                  << without.count() / with.count() << "x), " << mistakes << " pixels differ" << std::endl;
+    }
+
+    delete m;
+    outfile.close();
+    std::cout << std::endl;
+}